@@ -0,0 +1,115 @@
+/***************************************************************************
+ *   Copyright (C) 2013~2013 by Yichao Yu                                  *
+ *   yyc1992@gmail.com                                                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.              *
+ ***************************************************************************/
+
+/*
+  Checks that the SSE2 and AVX2 versions of qtcAdjustPix produce exactly the
+  same bytes as the scalar loop, for random pixels, sizes, strides (including
+  the padding between rows, which must be left alone) and shades. The SIMD
+  versions that are not available on this build or CPU are skipped.
+
+  Usage: qtcurve-adjustpix-check [-n cases] [-s seed]
+*/
+
+#include "common.h"
+
+#include <QByteArray>
+#include <QTextStream>
+
+#include <stdlib.h>
+#include <string.h>
+
+static const EAdjustPixImpl impls[] = {ADJUST_PIX_SSE2, ADJUST_PIX_AVX2};
+static const char *const implNames[] = {"sse2", "avx2"};
+
+static int
+randomInt(int min, int max)
+{
+    return min + rand() % (max - min + 1);
+}
+
+int
+main(int argc, char **argv)
+{
+    int cases = 2000;
+    unsigned seed = 1;
+    for (int i = 1;i < argc;i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+            cases = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+            seed = strtoul(argv[++i], 0, 0);
+        } else {
+            QTextStream(stderr) << "Usage: " << argv[0]
+                                << " [-n cases] [-s seed]\n";
+            return 1;
+        }
+    }
+    srand(seed);
+
+    QTextStream out(stdout);
+    bool available[2];
+    for (int i = 0;i < 2;i++) {
+        available[i] = qtcSetAdjustPixImpl(impls[i]);
+        out << implNames[i] << ": "
+            << (available[i] ? "checked" : "not available") << "\n";
+    }
+
+    int failures = 0;
+    for (int c = 0;c < cases;c++) {
+        // Mostly small widths, to cover the scalar tail of every vector
+        // width, with some larger ones.
+        int w = c % 4 ? randomInt(1, 40) : randomInt(41, 300);
+        int h = randomInt(1, 8);
+        int stride = w * 4 + randomInt(0, 3) * 4 + (c % 2 ? 0 : randomInt(1, 3));
+        int ro = randomInt(0, 255);
+        int go = randomInt(0, 255);
+        int bo = randomInt(0, 255);
+        // Shades above 1 make the clamping kick in.
+        double shade = randomInt(0, 400) / 100.0;
+
+        QByteArray input(stride * h, 0);
+        for (int i = 0;i < input.size();i++) {
+            input[i] = (char)rand();
+        }
+
+        QByteArray expected(input);
+        qtcSetAdjustPixImpl(ADJUST_PIX_SCALAR);
+        qtcAdjustPix((unsigned char*)expected.data(), 4, w, h, stride,
+                     ro, go, bo, shade);
+
+        for (int i = 0;i < 2;i++) {
+            if (!available[i])
+                continue;
+            QByteArray result(input);
+            qtcSetAdjustPixImpl(impls[i]);
+            qtcAdjustPix((unsigned char*)result.data(), 4, w, h, stride,
+                         ro, go, bo, shade);
+            if (result != expected) {
+                failures++;
+                out << implNames[i] << " differs: " << w << "x" << h
+                    << " stride " << stride << " rgb " << ro << "," << go
+                    << "," << bo << " shade " << shade << "\n";
+            }
+        }
+    }
+    qtcSetAdjustPixImpl(ADJUST_PIX_AUTO);
+
+    out << cases << " cases, " << failures << " failures\n";
+    return failures ? 1 : 0;
+}
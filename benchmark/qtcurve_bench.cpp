@@ -0,0 +1,740 @@
+/***************************************************************************
+ *   Copyright (C) 2013~2013 by Yichao Yu                                  *
+ *   yyc1992@gmail.com                                                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.              *
+ ***************************************************************************/
+
+/*
+  Headless rendering benchmark for the QtCurve style.
+
+  The style plugin is loaded from the build tree and run under the offscreen
+  QPA platform. Every element handled by drawPrimitive, drawControl and
+  drawComplexControl is drawn for a matrix of sizes and states, once for
+  each theme. One JSON object per line is written to stdout:
+
+    {"theme":..., "kind":"PE", "element":..., "size":"WxH", "state":...,
+     "ns_per_op":..., "allocs_per_op":..., "cache_hit_rate":...}
+
+  Afterwards a flood of mouse move events is sent to a few typical widgets,
+  to measure the cost of the style's event filter:
+
+    {"theme":..., "kind":"event", "element":"MouseMove", "widget":...,
+     "events_per_sec":...}
+
+  Finally a large generated form is laid out over and over, which mostly
+  exercises pixelMetric, styleHint and sizeFromContents:
+
+    {"theme":..., "kind":"layout", "element":"QFormLayout", "rows":...,
+     "ns_per_op":...}
+
+  Once for all themes, qtcAdjustPix (which recolours the check and radio
+  pixmaps) is run on a few image sizes with each available implementation:
+
+    {"kind":"pixel", "element":"qtcAdjustPix", "impl":..., "size":"WxH",
+     "ns_per_op":...}
+
+  Usage: qtcurve-bench [-i iterations] [-t theme.qtcurve]...
+*/
+
+#include <QApplication>
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QFormLayout>
+#include <QImage>
+#include <QLabel>
+#include <QLineEdit>
+#include <QMenuBar>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPluginLoader>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QStylePlugin>
+#include <QStyleOption>
+#include <QTextStream>
+#include <QTreeView>
+#include <QVariantMap>
+#include <QVBoxLayout>
+
+#include "common.h"
+
+#include <atomic>
+#include <stdlib.h>
+
+static std::atomic<unsigned long long> allocCount(0);
+
+#ifdef __GLIBC__
+// Count every allocation done in the process (including those of Qt and of
+// the style plugin) by interposing the glibc allocator entry points.
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t n, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void*
+malloc(size_t size)
+{
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void*
+calloc(size_t n, size_t size)
+{
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(n, size);
+}
+
+void*
+realloc(void *ptr, size_t size)
+{
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+}
+#endif
+
+enum OptionType {
+    OPT_DEFAULT,
+    OPT_BUTTON,
+    OPT_FRAME,
+    OPT_TAB_WIDGET_FRAME,
+    OPT_TAB_BAR_BASE,
+    OPT_FOCUS_RECT,
+    OPT_TOOL_BUTTON,
+    OPT_HEADER,
+    OPT_MENU_ITEM,
+    OPT_PROGRESS,
+    OPT_SPIN_BOX,
+    OPT_VIEW_ITEM,
+    OPT_TOOL_BAR,
+    OPT_DOCK_WIDGET,
+    OPT_TAB,
+    OPT_TOOL_BOX,
+    OPT_SLIDER,
+    OPT_SIZE_GRIP,
+    OPT_RUBBER_BAND,
+    OPT_COMBO_BOX,
+    OPT_GROUP_BOX,
+    OPT_TITLE_BAR
+};
+
+struct Element {
+    int id;
+    const char *name;
+    OptionType type;
+};
+
+#define ELEMENT(name, type) {QStyle::name, #name, type}
+
+static const Element primitives[] = {
+    ELEMENT(PE_Frame, OPT_FRAME),
+    ELEMENT(PE_FrameButtonBevel, OPT_BUTTON),
+    ELEMENT(PE_FrameButtonTool, OPT_TOOL_BUTTON),
+    ELEMENT(PE_FrameDefaultButton, OPT_BUTTON),
+    ELEMENT(PE_FrameDockWidget, OPT_FRAME),
+    ELEMENT(PE_FrameFocusRect, OPT_FOCUS_RECT),
+    ELEMENT(PE_FrameGroupBox, OPT_FRAME),
+    ELEMENT(PE_FrameLineEdit, OPT_FRAME),
+    ELEMENT(PE_FrameMenu, OPT_FRAME),
+    ELEMENT(PE_FrameStatusBar, OPT_DEFAULT),
+    ELEMENT(PE_FrameTabBarBase, OPT_TAB_BAR_BASE),
+    ELEMENT(PE_FrameTabWidget, OPT_TAB_WIDGET_FRAME),
+    ELEMENT(PE_FrameWindow, OPT_FRAME),
+    ELEMENT(PE_IndicatorArrowDown, OPT_DEFAULT),
+    ELEMENT(PE_IndicatorArrowLeft, OPT_DEFAULT),
+    ELEMENT(PE_IndicatorArrowRight, OPT_DEFAULT),
+    ELEMENT(PE_IndicatorArrowUp, OPT_DEFAULT),
+    ELEMENT(PE_IndicatorBranch, OPT_DEFAULT),
+    ELEMENT(PE_IndicatorButtonDropDown, OPT_TOOL_BUTTON),
+    ELEMENT(PE_IndicatorCheckBox, OPT_BUTTON),
+    ELEMENT(PE_IndicatorDockWidgetResizeHandle, OPT_DEFAULT),
+    ELEMENT(PE_IndicatorHeaderArrow, OPT_HEADER),
+    ELEMENT(PE_IndicatorMenuCheckMark, OPT_MENU_ITEM),
+    ELEMENT(PE_IndicatorProgressChunk, OPT_PROGRESS),
+    ELEMENT(PE_IndicatorRadioButton, OPT_BUTTON),
+    ELEMENT(PE_IndicatorSpinDown, OPT_SPIN_BOX),
+    ELEMENT(PE_IndicatorSpinMinus, OPT_SPIN_BOX),
+    ELEMENT(PE_IndicatorSpinPlus, OPT_SPIN_BOX),
+    ELEMENT(PE_IndicatorSpinUp, OPT_SPIN_BOX),
+    ELEMENT(PE_IndicatorTabClose, OPT_DEFAULT),
+    ELEMENT(PE_IndicatorToolBarHandle, OPT_DEFAULT),
+    ELEMENT(PE_IndicatorToolBarSeparator, OPT_DEFAULT),
+    ELEMENT(PE_IndicatorViewItemCheck, OPT_VIEW_ITEM),
+    ELEMENT(PE_PanelButtonBevel, OPT_BUTTON),
+    ELEMENT(PE_PanelButtonCommand, OPT_BUTTON),
+    ELEMENT(PE_PanelButtonTool, OPT_TOOL_BUTTON),
+    ELEMENT(PE_PanelItemViewItem, OPT_VIEW_ITEM),
+    ELEMENT(PE_PanelLineEdit, OPT_FRAME),
+    ELEMENT(PE_PanelMenuBar, OPT_DEFAULT),
+    ELEMENT(PE_PanelScrollAreaCorner, OPT_DEFAULT),
+    ELEMENT(PE_PanelTipLabel, OPT_FRAME),
+    ELEMENT(PE_Widget, OPT_DEFAULT)
+};
+
+// CE_QtC_* are private to the style (and need a real widget), not drawn here.
+static const Element controls[] = {
+    ELEMENT(CE_CheckBox, OPT_BUTTON),
+    ELEMENT(CE_CheckBoxLabel, OPT_BUTTON),
+    ELEMENT(CE_ComboBoxLabel, OPT_COMBO_BOX),
+    ELEMENT(CE_DockWidgetTitle, OPT_DOCK_WIDGET),
+    ELEMENT(CE_HeaderEmptyArea, OPT_DEFAULT),
+    ELEMENT(CE_HeaderLabel, OPT_HEADER),
+    ELEMENT(CE_HeaderSection, OPT_HEADER),
+    ELEMENT(CE_MenuBarEmptyArea, OPT_DEFAULT),
+    ELEMENT(CE_MenuBarItem, OPT_MENU_ITEM),
+    ELEMENT(CE_MenuEmptyArea, OPT_DEFAULT),
+    ELEMENT(CE_MenuHMargin, OPT_MENU_ITEM),
+    ELEMENT(CE_MenuItem, OPT_MENU_ITEM),
+    ELEMENT(CE_MenuScroller, OPT_MENU_ITEM),
+    ELEMENT(CE_MenuVMargin, OPT_MENU_ITEM),
+    ELEMENT(CE_ProgressBarContents, OPT_PROGRESS),
+    ELEMENT(CE_ProgressBarGroove, OPT_PROGRESS),
+    ELEMENT(CE_ProgressBarLabel, OPT_PROGRESS),
+    ELEMENT(CE_PushButton, OPT_BUTTON),
+    ELEMENT(CE_PushButtonBevel, OPT_BUTTON),
+    ELEMENT(CE_PushButtonLabel, OPT_BUTTON),
+    ELEMENT(CE_RadioButton, OPT_BUTTON),
+    ELEMENT(CE_RadioButtonLabel, OPT_BUTTON),
+    ELEMENT(CE_RubberBand, OPT_RUBBER_BAND),
+    ELEMENT(CE_ScrollBarAddLine, OPT_SLIDER),
+    ELEMENT(CE_ScrollBarAddPage, OPT_SLIDER),
+    ELEMENT(CE_ScrollBarSlider, OPT_SLIDER),
+    ELEMENT(CE_ScrollBarSubLine, OPT_SLIDER),
+    ELEMENT(CE_ScrollBarSubPage, OPT_SLIDER),
+    ELEMENT(CE_SizeGrip, OPT_SIZE_GRIP),
+    ELEMENT(CE_Splitter, OPT_DEFAULT),
+    ELEMENT(CE_TabBarTabLabel, OPT_TAB),
+    ELEMENT(CE_TabBarTabShape, OPT_TAB),
+    ELEMENT(CE_ToolBar, OPT_TOOL_BAR),
+    ELEMENT(CE_ToolBoxTabLabel, OPT_TOOL_BOX),
+    ELEMENT(CE_ToolBoxTabShape, OPT_TOOL_BOX),
+    ELEMENT(CE_ToolButtonLabel, OPT_TOOL_BUTTON)
+};
+
+static const Element complexControls[] = {
+    ELEMENT(CC_ComboBox, OPT_COMBO_BOX),
+    ELEMENT(CC_Dial, OPT_SLIDER),
+    ELEMENT(CC_GroupBox, OPT_GROUP_BOX),
+    ELEMENT(CC_ScrollBar, OPT_SLIDER),
+    ELEMENT(CC_Slider, OPT_SLIDER),
+    ELEMENT(CC_SpinBox, OPT_SPIN_BOX),
+    ELEMENT(CC_TitleBar, OPT_TITLE_BAR),
+    ELEMENT(CC_ToolButton, OPT_TOOL_BUTTON)
+};
+
+#undef ELEMENT
+
+static const QSize sizes[] = {
+    QSize(16, 16),
+    QSize(120, 24),
+    QSize(24, 120),
+    QSize(400, 32)
+};
+
+static const QStyle::State states[] = {
+    QStyle::State_None,
+    QStyle::State_Enabled | QStyle::State_Raised,
+    QStyle::State_Enabled | QStyle::State_MouseOver,
+    QStyle::State_Enabled | QStyle::State_HasFocus,
+    QStyle::State_Enabled | QStyle::State_Sunken | QStyle::State_On,
+    QStyle::State_Enabled | QStyle::State_Selected | QStyle::State_Active
+};
+
+static QStyleOption*
+createOption(OptionType type, bool horizontal)
+{
+    Qt::Orientation orientation = horizontal ? Qt::Horizontal : Qt::Vertical;
+
+    switch (type) {
+    default:
+    case OPT_DEFAULT:
+        return new QStyleOption;
+    case OPT_BUTTON: {
+        QStyleOptionButton *opt = new QStyleOptionButton;
+        opt->text = QLatin1String("&Button");
+        return opt;
+    }
+    case OPT_FRAME: {
+        QStyleOptionFrame *opt = new QStyleOptionFrame;
+        opt->lineWidth = 1;
+        return opt;
+    }
+    case OPT_TAB_WIDGET_FRAME: {
+        QStyleOptionTabWidgetFrame *opt = new QStyleOptionTabWidgetFrame;
+        opt->lineWidth = 1;
+        opt->tabBarSize = QSize(80, 24);
+        return opt;
+    }
+    case OPT_TAB_BAR_BASE:
+        return new QStyleOptionTabBarBase;
+    case OPT_FOCUS_RECT:
+        return new QStyleOptionFocusRect;
+    case OPT_TOOL_BUTTON: {
+        QStyleOptionToolButton *opt = new QStyleOptionToolButton;
+        opt->text = QLatin1String("Tool");
+        opt->subControls = QStyle::SC_ToolButton | QStyle::SC_ToolButtonMenu;
+        opt->features = QStyleOptionToolButton::MenuButtonPopup;
+        opt->toolButtonStyle = Qt::ToolButtonTextOnly;
+        return opt;
+    }
+    case OPT_HEADER: {
+        QStyleOptionHeader *opt = new QStyleOptionHeader;
+        opt->text = QLatin1String("Header");
+        opt->orientation = orientation;
+        opt->position = QStyleOptionHeader::Middle;
+        opt->sortIndicator = QStyleOptionHeader::SortDown;
+        return opt;
+    }
+    case OPT_MENU_ITEM: {
+        QStyleOptionMenuItem *opt = new QStyleOptionMenuItem;
+        opt->text = QLatin1String("&Menu item\tCtrl+M");
+        opt->menuItemType = QStyleOptionMenuItem::Normal;
+        opt->checkType = QStyleOptionMenuItem::NonExclusive;
+        opt->checked = true;
+        opt->maxIconWidth = 16;
+        opt->tabWidth = 40;
+        return opt;
+    }
+    case OPT_PROGRESS: {
+        QStyleOptionProgressBar *opt = new QStyleOptionProgressBar;
+        opt->minimum = 0;
+        opt->maximum = 100;
+        opt->progress = 40;
+        opt->text = QLatin1String("40%");
+        opt->textVisible = true;
+        opt->orientation = orientation;
+        return opt;
+    }
+    case OPT_SPIN_BOX: {
+        QStyleOptionSpinBox *opt = new QStyleOptionSpinBox;
+        opt->subControls = QStyle::SC_SpinBoxFrame | QStyle::SC_SpinBoxUp |
+            QStyle::SC_SpinBoxDown | QStyle::SC_SpinBoxEditField;
+        opt->stepEnabled = (QAbstractSpinBox::StepUpEnabled |
+                            QAbstractSpinBox::StepDownEnabled);
+        opt->frame = true;
+        return opt;
+    }
+    case OPT_VIEW_ITEM: {
+        QStyleOptionViewItemV4 *opt = new QStyleOptionViewItemV4;
+        opt->text = QLatin1String("Item");
+        opt->features = QStyleOptionViewItem::HasCheckIndicator;
+        opt->checkState = Qt::Checked;
+        opt->viewItemPosition = QStyleOptionViewItemV4::Middle;
+        return opt;
+    }
+    case OPT_TOOL_BAR:
+        return new QStyleOptionToolBar;
+    case OPT_DOCK_WIDGET: {
+        QStyleOptionDockWidget *opt = new QStyleOptionDockWidget;
+        opt->title = QLatin1String("Dock");
+        opt->closable = true;
+        opt->floatable = true;
+        return opt;
+    }
+    case OPT_TAB: {
+        QStyleOptionTab *opt = new QStyleOptionTab;
+        opt->text = QLatin1String("&Tab");
+        opt->position = QStyleOptionTab::Middle;
+        opt->shape = horizontal ? QTabBar::RoundedNorth : QTabBar::RoundedWest;
+        return opt;
+    }
+    case OPT_TOOL_BOX: {
+        QStyleOptionToolBox *opt = new QStyleOptionToolBox;
+        opt->text = QLatin1String("Page");
+        return opt;
+    }
+    case OPT_SLIDER: {
+        QStyleOptionSlider *opt = new QStyleOptionSlider;
+        opt->orientation = orientation;
+        opt->minimum = 0;
+        opt->maximum = 100;
+        opt->sliderPosition = opt->sliderValue = 30;
+        opt->pageStep = 10;
+        opt->singleStep = 1;
+        opt->subControls = QStyle::SC_All;
+        opt->tickPosition = QSlider::TicksBelow;
+        opt->tickInterval = 10;
+        return opt;
+    }
+    case OPT_SIZE_GRIP:
+        return new QStyleOptionSizeGrip;
+    case OPT_RUBBER_BAND: {
+        QStyleOptionRubberBand *opt = new QStyleOptionRubberBand;
+        opt->shape = QRubberBand::Rectangle;
+        opt->opaque = true;
+        return opt;
+    }
+    case OPT_COMBO_BOX: {
+        QStyleOptionComboBox *opt = new QStyleOptionComboBox;
+        opt->currentText = QLatin1String("Combo");
+        opt->editable = false;
+        opt->frame = true;
+        opt->subControls = QStyle::SC_All;
+        return opt;
+    }
+    case OPT_GROUP_BOX: {
+        QStyleOptionGroupBox *opt = new QStyleOptionGroupBox;
+        opt->text = QLatin1String("Group");
+        opt->lineWidth = 1;
+        opt->subControls = (QStyle::SC_GroupBoxFrame |
+                            QStyle::SC_GroupBoxLabel |
+                            QStyle::SC_GroupBoxCheckBox);
+        opt->features = QStyleOptionFrame::None;
+        return opt;
+    }
+    case OPT_TITLE_BAR: {
+        QStyleOptionTitleBar *opt = new QStyleOptionTitleBar;
+        opt->text = QLatin1String("Title");
+        opt->titleBarFlags = (Qt::WindowTitleHint | Qt::WindowSystemMenuHint |
+                              Qt::WindowMinMaxButtonsHint);
+        opt->subControls = QStyle::SC_All;
+        return opt;
+    }
+    }
+}
+
+enum ElementKind {
+    KIND_PRIMITIVE,
+    KIND_CONTROL,
+    KIND_COMPLEX
+};
+
+static const char *const kindNames[] = {"PE", "CE", "CC"};
+
+class Benchmark {
+public:
+    Benchmark(QStylePlugin *plugin, int iterations) :
+        itsPlugin(plugin),
+        itsStyle(0),
+        itsIterations(iterations),
+        itsOut(stdout)
+    {
+    }
+    ~Benchmark()
+    {
+        delete itsStyle;
+    }
+
+    bool setTheme(const QString &file)
+    {
+        delete itsStyle;
+        // Style::init() reads the config from here if it is set.
+        qputenv("QTCURVE_CONFIG_FILE", QFile::encodeName(file));
+        itsStyle = itsPlugin->create(QLatin1String("qtcurve"));
+        if (!itsStyle)
+            return false;
+        itsTheme = QFileInfo(file).completeBaseName();
+        itsPalette = itsStyle->standardPalette();
+        itsStyle->polish(itsPalette);
+        return true;
+    }
+
+    void run(ElementKind kind, const Element *elements, size_t n)
+    {
+        for (size_t i = 0;i < n;i++) {
+            for (const QSize &size: sizes) {
+                for (QStyle::State state: states) {
+                    runOne(kind, elements[i], size, state);
+                }
+            }
+        }
+    }
+
+    void runMouseFlood()
+    {
+        QWidget window;
+        QVBoxLayout *layout = new QVBoxLayout(&window);
+        QWidget *widgets[] = {
+            new QMenuBar(&window),
+            new QTreeView(&window),
+            new QLabel(QLatin1String("&Label"), &window),
+            new QPushButton(QLatin1String("Button"), &window)
+        };
+        for (QWidget *widget: widgets) {
+            layout->addWidget(widget);
+        }
+        applyStyle(&window);
+        window.resize(400, 300);
+        window.show();
+        QApplication::processEvents();
+
+        // Many more events than draw calls, they are much cheaper.
+        int count = itsIterations * 100;
+        for (QWidget *widget: widgets) {
+            QMouseEvent event(QEvent::MouseMove, QPointF(2, 2), Qt::NoButton,
+                              Qt::NoButton, Qt::NoModifier);
+            QElapsedTimer timer;
+            timer.start();
+            for (int i = 0;i < count;i++) {
+                QApplication::sendEvent(widget, &event);
+            }
+            qint64 ns = qMax(timer.nsecsElapsed(), (qint64)1);
+            itsOut << "{\"theme\":\"" << itsTheme << "\""
+                   << ",\"kind\":\"event\",\"element\":\"MouseMove\""
+                   << ",\"widget\":\"" << widget->metaObject()->className()
+                   << "\""
+                   << ",\"events_per_sec\":" << count * 1e9 / ns << "}\n";
+        }
+        itsOut.flush();
+        window.setStyle(0);
+    }
+
+    void runFormLayout()
+    {
+        static const int rows = 200;
+        QWidget window;
+        QFormLayout *layout = new QFormLayout(&window);
+        for (int i = 0;i < rows;i++) {
+            QWidget *field;
+            switch (i % 4) {
+            default:
+            case 0:
+                field = new QLineEdit(&window);
+                break;
+            case 1: {
+                QComboBox *combo = new QComboBox(&window);
+                combo->addItem(QLatin1String("Item"));
+                field = combo;
+                break;
+            }
+            case 2:
+                field = new QSpinBox(&window);
+                break;
+            case 3:
+                field = new QCheckBox(QLatin1String("&Check"), &window);
+                break;
+            }
+            layout->addRow(QString::fromLatin1("Row &%1:").arg(i), field);
+        }
+        applyStyle(&window);
+        layout->activate();
+
+        // updateGeometry() drops the size hints the layout items cache, so
+        // that every pass asks the widgets (and so the style) again.
+        QList<QWidget*> children = window.findChildren<QWidget*>();
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0;i < itsIterations;i++) {
+            foreach (QWidget *child, children) {
+                child->updateGeometry();
+            }
+            layout->activate();
+        }
+        qint64 ns = timer.nsecsElapsed();
+        QApplication::removePostedEvents(0, QEvent::LayoutRequest);
+        itsOut << "{\"theme\":\"" << itsTheme << "\""
+               << ",\"kind\":\"layout\",\"element\":\"QFormLayout\""
+               << ",\"rows\":" << rows
+               << ",\"ns_per_op\":" << ns / itsIterations << "}\n";
+        itsOut.flush();
+    }
+
+    void runAdjustPix()
+    {
+        static const struct {
+            EAdjustPixImpl impl;
+            const char *name;
+        } impls[] = {
+            {ADJUST_PIX_SCALAR, "scalar"},
+            {ADJUST_PIX_SSE2, "sse2"},
+            {ADJUST_PIX_AVX2, "avx2"}
+        };
+        static const QSize pixSizes[] = {
+            QSize(13, 13), QSize(64, 64), QSize(256, 256)
+        };
+        for (const QSize &size: pixSizes) {
+            QImage img(size, QImage::Format_ARGB32_Premultiplied);
+            img.fill(0xff808080);
+            for (const auto &impl: impls) {
+                if (!qtcSetAdjustPixImpl(impl.impl))
+                    continue;
+                QElapsedTimer timer;
+                timer.start();
+                for (int i = 0;i < itsIterations;i++) {
+                    qtcAdjustPix(img.bits(), 4, img.width(), img.height(),
+                                 img.bytesPerLine(), 64, 128, 192, 1.0);
+                }
+                qint64 ns = timer.nsecsElapsed();
+                itsOut << "{\"kind\":\"pixel\",\"element\":\"qtcAdjustPix\""
+                       << ",\"impl\":\"" << impl.name << "\""
+                       << ",\"size\":\"" << size.width() << "x"
+                       << size.height() << "\""
+                       << ",\"ns_per_op\":" << ns / itsIterations << "}\n";
+            }
+        }
+        qtcSetAdjustPixImpl(ADJUST_PIX_AUTO);
+        itsOut.flush();
+    }
+
+private:
+    // QWidget::setStyle() does not propagate to the children.
+    void applyStyle(QWidget *window)
+    {
+        window->setStyle(itsStyle);
+        foreach (QWidget *child, window->findChildren<QWidget*>()) {
+            child->setStyle(itsStyle);
+        }
+    }
+
+    void draw(ElementKind kind, int id, const QStyleOption *opt,
+              QPainter *p) const
+    {
+        switch (kind) {
+        case KIND_PRIMITIVE:
+            itsStyle->drawPrimitive((QStyle::PrimitiveElement)id, opt, p, 0);
+            break;
+        case KIND_CONTROL:
+            itsStyle->drawControl((QStyle::ControlElement)id, opt, p, 0);
+            break;
+        case KIND_COMPLEX:
+            itsStyle->drawComplexControl(
+                (QStyle::ComplexControl)id,
+                static_cast<const QStyleOptionComplex*>(opt), p, 0);
+            break;
+        }
+    }
+
+    QVariantMap cacheStatistics() const
+    {
+        QVariantMap stats;
+        QMetaObject::invokeMethod(itsStyle, "cacheStatistics",
+                                  Q_RETURN_ARG(QVariantMap, stats));
+        return stats;
+    }
+
+    void runOne(ElementKind kind, const Element &element, const QSize &size,
+                QStyle::State state)
+    {
+        bool horizontal = size.width() >= size.height();
+        QStyleOption *opt = createOption(element.type, horizontal);
+        opt->rect = QRect(QPoint(0, 0), size);
+        opt->state |= state;
+        if (horizontal)
+            opt->state |= QStyle::State_Horizontal;
+        opt->palette = itsPalette;
+        opt->fontMetrics = QFontMetrics(QApplication::font());
+
+        QImage image(size, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+        QPainter p(&image);
+
+        // Warm up, so that the first (uncached) paint is not measured.
+        draw(kind, element.id, opt, &p);
+
+        QVariantMap before = cacheStatistics();
+        unsigned long long allocs = allocCount.load();
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0;i < itsIterations;i++) {
+            draw(kind, element.id, opt, &p);
+        }
+        qint64 ns = timer.nsecsElapsed();
+        allocs = allocCount.load() - allocs;
+        QVariantMap after = cacheStatistics();
+        p.end();
+        delete opt;
+
+        qulonglong hits = (after["hits"].toULongLong() -
+                           before["hits"].toULongLong());
+        qulonglong lookups = hits + (after["misses"].toULongLong() -
+                                     before["misses"].toULongLong());
+
+        itsOut << "{\"theme\":\"" << itsTheme << "\""
+               << ",\"kind\":\"" << kindNames[kind] << "\""
+               << ",\"element\":\"" << element.name << "\""
+               << ",\"size\":\"" << size.width() << 'x' << size.height()
+               << "\""
+               << ",\"state\":" << (uint)state
+               << ",\"ns_per_op\":" << (double)ns / itsIterations
+               << ",\"allocs_per_op\":" << (double)allocs / itsIterations
+               << ",\"cache_hit_rate\":";
+        if (lookups) {
+            itsOut << (double)hits / lookups;
+        } else {
+            itsOut << "null";
+        }
+        itsOut << "}\n";
+        itsOut.flush();
+    }
+
+    QStylePlugin *itsPlugin;
+    QStyle *itsStyle;
+    int itsIterations;
+    QString itsTheme;
+    QPalette itsPalette;
+    QTextStream itsOut;
+};
+
+int
+main(int argc, char **argv)
+{
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    int iterations = 200;
+    QStringList themes;
+    QStringList args = app.arguments();
+    for (int i = 1;i < args.size();i++) {
+        if (args[i] == QLatin1String("-i") && i + 1 < args.size()) {
+            iterations = qMax(args[++i].toInt(), 1);
+        } else if (args[i] == QLatin1String("-t") && i + 1 < args.size()) {
+            themes << args[++i];
+        } else {
+            QTextStream(stderr) << "Usage: " << args[0]
+                                << " [-i iterations] [-t theme.qtcurve]...\n";
+            return 1;
+        }
+    }
+    if (themes.isEmpty()) {
+        QDir dir(QLatin1String(QTC_BENCH_THEMES_DIR));
+        foreach (const QString &file,
+                 dir.entryList(QStringList() << "*.qtcurve", QDir::Files,
+                               QDir::Name)) {
+            themes << dir.absoluteFilePath(file);
+        }
+    }
+
+    QPluginLoader loader(QLatin1String(QTC_BENCH_STYLE_PLUGIN));
+    QStylePlugin *plugin = qobject_cast<QStylePlugin*>(loader.instance());
+    if (!plugin) {
+        QTextStream(stderr) << "Cannot load " << QTC_BENCH_STYLE_PLUGIN
+                            << ": " << loader.errorString() << "\n";
+        return 1;
+    }
+
+    Benchmark bench(plugin, iterations);
+    foreach (const QString &theme, themes) {
+        if (!bench.setTheme(theme)) {
+            QTextStream(stderr) << "Cannot create style for " << theme << "\n";
+            return 1;
+        }
+        bench.run(KIND_PRIMITIVE, primitives,
+                  sizeof(primitives) / sizeof(primitives[0]));
+        bench.run(KIND_CONTROL, controls,
+                  sizeof(controls) / sizeof(controls[0]));
+        bench.run(KIND_COMPLEX, complexControls,
+                  sizeof(complexControls) / sizeof(complexControls[0]));
+        bench.runMouseFlood();
+        bench.runFormLayout();
+    }
+    bench.runAdjustPix();
+    return 0;
+}
@@ -10,6 +10,30 @@
 #include <stdlib.h>
 #endif
 
+/* x86 only, so the data is always little endian here */
+#if defined __GNUC__ && defined __SSE2__ && (defined __x86_64__ || defined __i386__)
+#define QTC_ADJUST_PIX_SIMD
+#include <emmintrin.h>
+#if defined __clang__ || __GNUC__ >= 5
+#define QTC_ADJUST_PIX_AVX2
+#include <immintrin.h>
+#endif
+/* Byte index of each channel within a pixel */
+#if defined __cplusplus
+/* BGRA */
+#define QTC_PIX_B 0
+#define QTC_PIX_G 1
+#define QTC_PIX_R 2
+#define QTC_PIX_A 3
+#else
+/* GdkPixbuf is RGBA */
+#define QTC_PIX_R 0
+#define QTC_PIX_G 1
+#define QTC_PIX_B 2
+#define QTC_PIX_A 3
+#endif
+#endif
+
 /* Taken from rgb->hsl routines taken from KColor
     Copyright 2007 Matthew Woehlke <mw_triad@users.sourceforge.net>
 */
@@ -315,6 +339,131 @@ static unsigned char checkBounds(int num)
                        num;
 }
 
+static inline void adjustPixel(unsigned char *data, int r, int g, int b)
+{
+    unsigned char source=data[1];
+
+#if defined  __cplusplus
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    /* ARGB */
+    data[1] = checkBounds(r-source);
+    data[2] = checkBounds(g-source);
+    data[3] = checkBounds(b-source);
+#else
+    /* BGRA */
+    data[0] = checkBounds(b-source);
+    data[1] = checkBounds(g-source);
+    data[2] = checkBounds(r-source);
+#endif
+#else
+    /* GdkPixbuf is RGBA */
+    data[0] = checkBounds(r-source);
+    data[1] = checkBounds(g-source);
+    data[2] = checkBounds(b-source);
+#endif
+}
+
+#ifdef QTC_ADJUST_PIX_SIMD
+/*
+  Vector versions of the loop below for 4 channel data, 4 (SSE2) or 8 (AVX2)
+  pixels at a time. The channels are widened to 16bit, the source byte (the
+  second one of each pixel) is broadcast over its pixel and subtracted from the
+  per byte colour. Packing back to bytes with unsigned saturation does the same
+  clamping as checkBounds(), so the result is identical to the scalar code.
+  The byte that is not recoloured (alpha) is copied from the input.
+*/
+static void adjustPixSse2(unsigned char *data, int w, int h, int stride, const short *cols, int keep)
+{
+    __m128i zero=_mm_setzero_si128(),
+            kv=_mm_setr_epi16(cols[0], cols[1], cols[2], cols[3], cols[0], cols[1], cols[2], cols[3]),
+            keepMask=_mm_set1_epi32(0xFF<<(keep*8));
+    int     row;
+
+    for(row=0; row<h; ++row)
+    {
+        unsigned char *line=data+row*stride;
+        int           x=0;
+
+        for(; x+4<=w; x+=4)
+        {
+            __m128i px=_mm_loadu_si128((const __m128i *)(line+x*4)),
+                    lo=_mm_unpacklo_epi8(px, zero),
+                    hi=_mm_unpackhi_epi8(px, zero),
+                    res;
+
+            lo=_mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(1, 1, 1, 1)), _MM_SHUFFLE(1, 1, 1, 1));
+            hi=_mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(1, 1, 1, 1)), _MM_SHUFFLE(1, 1, 1, 1));
+            res=_mm_packus_epi16(_mm_sub_epi16(kv, lo), _mm_sub_epi16(kv, hi));
+            res=_mm_or_si128(_mm_andnot_si128(keepMask, res), _mm_and_si128(keepMask, px));
+            _mm_storeu_si128((__m128i *)(line+x*4), res);
+        }
+        for(; x<w; ++x)
+            adjustPixel(line+x*4, cols[QTC_PIX_R], cols[QTC_PIX_G], cols[QTC_PIX_B]);
+    }
+}
+
+#ifdef QTC_ADJUST_PIX_AVX2
+__attribute__((target("avx2")))
+static void adjustPixAvx2(unsigned char *data, int w, int h, int stride, const short *cols, int keep)
+{
+    /* unpack, shuffle and pack all work within 128bit lanes, so the pixel order is preserved */
+    __m256i zero=_mm256_setzero_si256(),
+            kv=_mm256_setr_epi16(cols[0], cols[1], cols[2], cols[3], cols[0], cols[1], cols[2], cols[3],
+                                 cols[0], cols[1], cols[2], cols[3], cols[0], cols[1], cols[2], cols[3]),
+            keepMask=_mm256_set1_epi32(0xFF<<(keep*8));
+    int     row;
+
+    for(row=0; row<h; ++row)
+    {
+        unsigned char *line=data+row*stride;
+        int           x=0;
+
+        for(; x+8<=w; x+=8)
+        {
+            __m256i px=_mm256_loadu_si256((const __m256i *)(line+x*4)),
+                    lo=_mm256_unpacklo_epi8(px, zero),
+                    hi=_mm256_unpackhi_epi8(px, zero),
+                    res;
+
+            lo=_mm256_shufflehi_epi16(_mm256_shufflelo_epi16(lo, _MM_SHUFFLE(1, 1, 1, 1)), _MM_SHUFFLE(1, 1, 1, 1));
+            hi=_mm256_shufflehi_epi16(_mm256_shufflelo_epi16(hi, _MM_SHUFFLE(1, 1, 1, 1)), _MM_SHUFFLE(1, 1, 1, 1));
+            res=_mm256_packus_epi16(_mm256_sub_epi16(kv, lo), _mm256_sub_epi16(kv, hi));
+            res=_mm256_or_si256(_mm256_andnot_si256(keepMask, res), _mm256_and_si256(keepMask, px));
+            _mm256_storeu_si256((__m256i *)(line+x*4), res);
+        }
+        for(; x<w; ++x)
+            adjustPixel(line+x*4, cols[QTC_PIX_R], cols[QTC_PIX_G], cols[QTC_PIX_B]);
+    }
+}
+#endif
+#endif
+
+static EAdjustPixImpl adjustPixImpl=ADJUST_PIX_AUTO;
+
+bool qtcSetAdjustPixImpl(EAdjustPixImpl impl)
+{
+    switch(impl)
+    {
+    case ADJUST_PIX_AUTO:
+    case ADJUST_PIX_SCALAR:
+        break;
+#ifdef QTC_ADJUST_PIX_SIMD
+    case ADJUST_PIX_SSE2:
+        break;
+#ifdef QTC_ADJUST_PIX_AVX2
+    case ADJUST_PIX_AVX2:
+        if(!__builtin_cpu_supports("avx2"))
+            return false;
+        break;
+#endif
+#endif
+    default:
+        return false;
+    }
+    adjustPixImpl=impl;
+    return true;
+}
+
 void qtcAdjustPix(unsigned char *data, int numChannels, int w, int h, int stride, int ro, int go, int bo, double shade)
 {
     int width=w*numChannels,
@@ -324,34 +473,34 @@ void qtcAdjustPix(unsigned char *data, int numChannels, int w, int h, int stride
         g=(int)((go*shade)+0.5),
         b=(int)((bo*shade)+0.5);
 
-    for(row=0; row<h; ++row)
+#ifdef QTC_ADJUST_PIX_SIMD
+    /* The 16bit lanes must not overflow when the source is subtracted */
+    if(4==numChannels && ADJUST_PIX_SCALAR!=adjustPixImpl && r>=-32000 && r<=32000 && g>=-32000 && g<=32000 && b>=-32000 && b<=32000)
     {
-        int column;
-
-        for(column=0; column<width; column+=numChannels)
+        short cols[4];
+
+        cols[QTC_PIX_R]=r;
+        cols[QTC_PIX_G]=g;
+        cols[QTC_PIX_B]=b;
+        cols[QTC_PIX_A]=0;
+#ifdef QTC_ADJUST_PIX_AVX2
+        if(ADJUST_PIX_AVX2==adjustPixImpl || (ADJUST_PIX_AUTO==adjustPixImpl && __builtin_cpu_supports("avx2")))
         {
-            unsigned char source=data[offset+column+1];
-
-#if defined  __cplusplus
-#if Q_BYTE_ORDER == Q_BIG_ENDIAN
-            /* ARGB */
-            data[offset+column+1] = checkBounds(r-source);
-            data[offset+column+2] = checkBounds(g-source);
-            data[offset+column+3] = checkBounds(b-source);
-#else
-            /* BGRA */
-            data[offset+column] = checkBounds(b-source);
-            data[offset+column+1] = checkBounds(g-source);
-            data[offset+column+2] = checkBounds(r-source);
+            adjustPixAvx2(data, w, h, stride, cols, QTC_PIX_A);
+            return;
+        }
 #endif
-#else
-            /* GdkPixbuf is RGBA */
-            data[offset+column] = checkBounds(r-source);
-            data[offset+column+1] = checkBounds(g-source);
-            data[offset+column+2] = checkBounds(b-source);
+        adjustPixSse2(data, w, h, stride, cols, QTC_PIX_A);
+        return;
+    }
 #endif
 
-        }
+    for(row=0; row<h; ++row)
+    {
+        int column;
+
+        for(column=0; column<width; column+=numChannels)
+            adjustPixel(data+offset+column, r, g, b);
         offset+=stride;
     }
 }
@@ -257,6 +257,11 @@ enum
 #define MIN_MENU_DELAY       1
 #define MAX_MENU_DELAY     500
 
+/* Size of the style's pixmap cache, in KiB */
+#define DEFAULT_PIXMAP_CACHE_SIZE 10240
+#define MIN_PIXMAP_CACHE_SIZE       512
+#define MAX_PIXMAP_CACHE_SIZE    262144
+
 #define DEFAULT_SLIDER_WIDTH  15
 #define MIN_SLIDER_WIDTH_ROUND 7
 #define MIN_SLIDER_WIDTH_THIN_GROOVE 9
@@ -1075,6 +1080,7 @@ typedef struct
                      highlightFactor,
                      lighterPopupMenuBgnd,
                      menuDelay,
+                     pixmapCacheSize,
                      sliderWidth,
                      tabBgnd,
                      colorSelTab,
@@ -1297,7 +1303,17 @@ extern void qtcShade(const Options *opts, const color &ca, color *cb, double k);
 extern void qtcShade(const Options *opts, const color *ca, color *cb, double k);
 #endif
 
+typedef enum
+{
+    ADJUST_PIX_AUTO,
+    ADJUST_PIX_SCALAR,
+    ADJUST_PIX_SSE2,
+    ADJUST_PIX_AVX2
+} EAdjustPixImpl;
+
 extern void qtcAdjustPix(unsigned char *data, int numChannels, int w, int h, int stride, int ro, int go, int bo, double shade);
+/* Force the code path used by qtcAdjustPix, for the tests and the benchmark. Returns false if it is not available. */
+extern bool qtcSetAdjustPixImpl(EAdjustPixImpl impl);
 extern void qtcSetupGradient(Gradient *grad, EGradientBorder border, int numStops, ...);
 extern const Gradient * qtcGetGradient(EAppearance app, const Options *opts);
 
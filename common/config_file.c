@@ -899,6 +899,106 @@ void qtcSetBarHidden(const char *app, bool hidden, const char *prefix)
 #ifdef __cplusplus
 #include <QSvgRenderer>
 #include <QPainter>
+#include <QImage>
+#include <QImageReader>
+#include <QFileInfo>
+#include <QDir>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QStandardPaths>
+
+/*
+  Generated files (rasterised images, option snapshots) go into the XDG cache dir, not next to the config.
+*/
+static QString cacheDir()
+{
+    QString dir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation));
+
+    return dir.isEmpty() ? dir : dir+QLatin1String("/qtcurve/");
+}
+
+/*
+  SVGs, and images that have to be scaled, are stored rasterised in the cache dir, keyed on the path and mtime of the
+  file and the target size. Only the latest rendering of each file is kept.
+*/
+static QString bgndImageCachePrefix(const QFileInfo &info)
+{
+    return QLatin1String("bgnd-")+QString::number(qHash(info.absoluteFilePath()), 16)+QLatin1Char('-');
+}
+
+static QString bgndImageCacheFile(const QFileInfo &info, int width, int height)
+{
+    QString dir(cacheDir());
+
+    return dir.isEmpty()
+        ? dir
+        : dir+bgndImageCachePrefix(info)+QString::number(info.lastModified().toMSecsSinceEpoch(), 16)+QLatin1Char('-')+
+          QString::number(width)+QLatin1Char('x')+QString::number(height)+QLatin1String(".png");
+}
+
+/*
+  Remove the renderings of older versions, or other sizes, of the same file.
+*/
+static void pruneBgndImageCache(const QFileInfo &info, const QString &keep)
+{
+    QDir    dir(cacheDir());
+    QString keepName(QFileInfo(keep).fileName());
+
+    foreach(const QString &name, dir.entryList(QStringList() << bgndImageCachePrefix(info)+QLatin1String("*.png"), QDir::Files))
+        if(name!=keepName)
+            dir.remove(name);
+}
+
+/*
+  Only uses QImage (not QPixmap), so that this can be called from a worker thread.
+*/
+QImage qtcDecodeBgndImage(const QString &name, int width, int height)
+{
+    QString file(determineFileName(name));
+    QImage  img;
+
+    if(file.isEmpty())
+        return img;
+
+    bool      svg=file.endsWith(".svg", Qt::CaseInsensitive) || file.endsWith(".svgz", Qt::CaseInsensitive);
+    QFileInfo info(file);
+    QString   cacheFile(0!=width && info.exists() && getenv("QTCURVE_NO_CONFIG_CACHE")==NULL
+                        ? bgndImageCacheFile(info, width, height) : QString());
+
+    if(!cacheFile.isEmpty() && img.load(cacheFile, "PNG") && img.width()==width && img.height()==height)
+        return img;
+
+    bool loaded=false,
+         scaled=false;
+
+    if(0!=width && svg)
+    {
+        QSvgRenderer renderer(file);
+
+        if(renderer.isValid())
+        {
+            img=QImage(width, height, QImage::Format_ARGB32_Premultiplied);
+            img.fill(Qt::transparent);
+            QPainter painter(&img);
+            renderer.render(&painter);
+            painter.end();
+            loaded=scaled=true;
+        }
+    }
+    if(!loaded && img.load(file) && 0!=width && (img.height()!=height || img.width()!=width))
+    {
+        img=img.scaled(width, height, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        scaled=true;
+    }
+    if(scaled && !cacheFile.isEmpty() && QDir().mkpath(cacheDir()))
+    {
+        QSaveFile f(cacheFile);
+
+        if(f.open(QIODevice::WriteOnly) && img.save(&f, "PNG") && f.commit())
+            pruneBgndImageCache(info, cacheFile);
+    }
+    return img;
+}
 #endif // __cplusplus
 
 void qtcLoadBgndImage(QtCImage *img)
@@ -908,30 +1008,7 @@ void qtcLoadBgndImage(QtCImage *img)
     {
         img->loaded=true;
 #ifdef __cplusplus
-        img->pixmap.img=QPixmap();
-        QString file(determineFileName(img->pixmap.file));
-
-        if(!file.isEmpty())
-        {
-            bool loaded=false;
-            if(0!=img->width && (file.endsWith(".svg", Qt::CaseInsensitive) || file.endsWith(".svgz", Qt::CaseInsensitive)))
-            {
-                QSvgRenderer svg(file);
-
-                if(svg.isValid())
-                {
-                    img->pixmap.img=QPixmap(img->width, img->height);
-                    img->pixmap.img.fill(Qt::transparent);
-                    QPainter painter(&img->pixmap.img);
-                    svg.render(&painter);
-                    painter.end();
-                    loaded=true;
-                }
-            }
-            if(!loaded && img->pixmap.img.load(file) && 0!=img->width &&
-               (img->pixmap.img.height()!=img->height || img->pixmap.img.width()!=img->width))
-                img->pixmap.img=img->pixmap.img.scaled(img->width, img->height, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
-        }
+        img->pixmap.img=QPixmap::fromImage(qtcDecodeBgndImage(img->pixmap.file, img->width, img->height));
 #else // __cplusplus
         img->pixmap.img=0L;
         if(img->pixmap.file)
@@ -1551,6 +1628,9 @@ void qtcCheckConfig(Options *opts)
     else if(opts->menuDelay<MIN_MENU_DELAY || opts->menuDelay>MAX_MENU_DELAY)
         opts->menuDelay=DEFAULT_MENU_DELAY;
 
+    if(opts->pixmapCacheSize<MIN_PIXMAP_CACHE_SIZE || opts->pixmapCacheSize>MAX_PIXMAP_CACHE_SIZE)
+        opts->pixmapCacheSize=DEFAULT_PIXMAP_CACHE_SIZE;
+
     if(0==opts->sliderWidth%2)
         opts->sliderWidth++;
 
@@ -1692,6 +1772,238 @@ void qtcCheckConfig(Options *opts)
         opts->toolbarSeparators=LINE_DOTS;
 }
 
+#if defined __cplusplus && !defined CONFIG_DIALOG && QT_VERSION >= 0x050000
+/*
+  Binary snapshot of the resolved options, so that only the first process after the config file changes has to parse
+  it. The snapshot is keyed on the QtCurve version and build, and on the path, mtime and size of the config file (and
+  of the system wide one, which provides the defaults). Everything before titlebarButtonColors, and between that and customGradient, is plain data
+  and is stored as two raw blocks; the remaining members are streamed. Set QTCURVE_NO_CONFIG_CACHE to bypass it.
+*/
+#define QTC_CONFIG_CACHE
+#include <QDataStream>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDateTime>
+
+#define CONFIG_CACHE_MAGIC   0x51544343 /* QTCC */
+#define CONFIG_CACHE_VERSION 1
+
+static const char * getSystemConfigFile();
+
+static QString configCacheFile(const QString &file)
+{
+    QString dir(cacheDir());
+
+    return dir.isEmpty()
+        ? dir
+        : dir+QLatin1String("options-")+QString::number(qHash(QFileInfo(file).absoluteFilePath()), 16)+
+          QLatin1String(".cache");
+}
+
+static void writeCacheHeader(QDataStream &str, const QString &file)
+{
+    QFileInfo  info(file);
+    const char *sysFile=getSystemConfigFile();
+    QFileInfo  sysInfo(sysFile ? QFile::decodeName(sysFile) : QString());
+
+    // The raw blocks hold enum values, which a new build may have renumbered without changing the size of Options.
+    str << (quint32)CONFIG_CACHE_MAGIC << (quint32)CONFIG_CACHE_VERSION << (quint32)QT_VERSION
+        << QByteArray(VERSION) << QByteArray(__DATE__ " " __TIME__)
+        << (quint32)sizeof(Options) << info.absoluteFilePath()
+        << (qint64)info.lastModified().toMSecsSinceEpoch() << (qint64)info.size()
+        << (qint64)(sysFile ? sysInfo.lastModified().toMSecsSinceEpoch() : 0) << (qint64)(sysFile ? sysInfo.size() : 0);
+}
+
+static inline void configRawBlocks(Options *opts, char **start, int *size)
+{
+    char *base=(char *)opts,
+         *tbCols=(char *)&opts->titlebarButtonColors,
+         *grad=(char *)&opts->customGradient;
+
+    start[0]=base;
+    size[0]=tbCols-base;
+    start[1]=tbCols+sizeof(TBCols);
+    size[1]=grad-start[1];
+}
+
+static void writeImage(QDataStream &str, const QtCImage &img)
+{
+    str << (qint32)img.type << img.onBorder << img.pixmap.file << (qint32)img.width << (qint32)img.height
+        << (qint32)img.pos;
+}
+
+static void readImage(QDataStream &str, QtCImage &img)
+{
+    qint32 type, width, height, pos;
+
+    str >> type >> img.onBorder >> img.pixmap.file >> width >> height >> pos;
+    img.type=(EImageType)type;
+    img.width=width;
+    img.height=height;
+    img.pos=(EPixPos)pos;
+    img.loaded=false;
+    img.pixmap.img=QPixmap();
+}
+
+static void writeConfigCache(const QString &file, Options *opts)
+{
+    QString cacheFile(configCacheFile(file));
+
+    if(cacheFile.isEmpty())
+        return;
+
+    QByteArray  data;
+    QDataStream str(&data, QIODevice::WriteOnly);
+    char        *start[2];
+    int         size[2];
+
+    str.setVersion(QDataStream::Qt_5_0);
+    writeCacheHeader(str, file);
+    configRawBlocks(opts, start, size);
+    for(int i=0; i<2; ++i)
+    {
+        str << (quint32)size[i];
+        str.writeRawData(start[i], size[i]);
+    }
+
+    str << (quint32)opts->titlebarButtonColors.size();
+    for(TBCols::const_iterator it(opts->titlebarButtonColors.begin()), end(opts->titlebarButtonColors.end()); it!=end; ++it)
+        str << (qint32)(*it).first << (*it).second;
+
+    str << (quint32)opts->customGradient.size();
+    for(GradientCont::const_iterator it(opts->customGradient.begin()), end(opts->customGradient.end()); it!=end; ++it)
+    {
+        str << (qint32)(*it).first << (qint32)(*it).second.border << (quint32)(*it).second.stops.size();
+        for(GradientStopCont::const_iterator s((*it).second.stops.begin()), send((*it).second.stops.end()); s!=send; ++s)
+            str << (*s).pos << (*s).val << (*s).alpha;
+    }
+
+    str << opts->bgndPixmap.file << opts->menuBgndPixmap.file;
+    writeImage(str, opts->bgndImage);
+    writeImage(str, opts->menuBgndImage);
+    str << opts->noBgndGradientApps << opts->noBgndOpacityApps << opts->noMenuBgndOpacityApps << opts->noBgndImageApps
+#ifdef QTC_ENABLE_PARENTLESS_DIALOG_FIX_SUPPORT
+        << opts->noDlgFixApps
+#endif
+        << opts->noMenuStripeApps << opts->menubarApps << opts->statusbarApps << opts->useQtFileDialogApps
+        << opts->windowDragWhiteList << opts->windowDragBlackList;
+    str << (quint32)qChecksum(data.constData(), data.size());
+
+    QSaveFile f(cacheFile);
+
+    if(str.status()==QDataStream::Ok && QDir().mkpath(cacheDir()) && f.open(QIODevice::WriteOnly) &&
+       f.write(data)==data.size())
+        f.commit();
+}
+
+static bool readConfigCache(const QString &file, Options *opts, bool checkImages)
+{
+    QString cacheFile(configCacheFile(file));
+
+    if(cacheFile.isEmpty())
+        return false;
+
+    QFile f(cacheFile);
+
+    if(!f.open(QIODevice::ReadOnly) || f.size()<(qint64)sizeof(quint32))
+        return false;
+
+    uchar *map=f.map(0, f.size());
+
+    if(!map)
+        return false;
+
+    int        len=f.size()-sizeof(quint32);
+    QByteArray data(QByteArray::fromRawData((const char *)map, len)),
+               expected;
+    QDataStream trailer(QByteArray::fromRawData((const char *)map+len, sizeof(quint32))),
+               header(&expected, QIODevice::WriteOnly);
+    quint32    checksum;
+
+    trailer >> checksum;
+    header.setVersion(QDataStream::Qt_5_0);
+    writeCacheHeader(header, file);
+    if(checksum!=qChecksum(data.constData(), data.size()) || !data.startsWith(expected))
+        return false;
+
+    // The header matched, so the snapshot was written by this very build and the layout of Options is the same.
+    QDataStream str(data);
+    Options     newOpts;
+    char        *start[2];
+    int         size[2];
+
+    str.setVersion(QDataStream::Qt_5_0);
+    str.skipRawData(expected.size());
+    configRawBlocks(&newOpts, start, size);
+    for(int i=0; i<2; ++i)
+    {
+        quint32 blockSize;
+
+        str >> blockSize;
+        if(blockSize!=(quint32)size[i] || str.readRawData(start[i], size[i])!=size[i])
+            return false;
+    }
+
+    quint32 count;
+
+    str >> count;
+    for(quint32 i=0; i<count && str.status()==QDataStream::Ok; ++i)
+    {
+        qint32 key;
+        QColor col;
+
+        str >> key >> col;
+        newOpts.titlebarButtonColors[key]=col;
+    }
+
+    str >> count;
+    for(quint32 i=0; i<count && str.status()==QDataStream::Ok; ++i)
+    {
+        qint32   app, border;
+        quint32  numStops;
+        Gradient grad;
+
+        str >> app >> border >> numStops;
+        grad.border=(EGradientBorder)border;
+        for(quint32 s=0; s<numStops && str.status()==QDataStream::Ok; ++s)
+        {
+            double pos, val, alpha;
+
+            str >> pos >> val >> alpha;
+            grad.stops.insert(GradientStop(pos, val, alpha));
+        }
+        newOpts.customGradient[(EAppearance)app]=grad;
+    }
+
+    str >> newOpts.bgndPixmap.file >> newOpts.menuBgndPixmap.file;
+    readImage(str, newOpts.bgndImage);
+    readImage(str, newOpts.menuBgndImage);
+    str >> newOpts.noBgndGradientApps >> newOpts.noBgndOpacityApps >> newOpts.noMenuBgndOpacityApps
+        >> newOpts.noBgndImageApps
+#ifdef QTC_ENABLE_PARENTLESS_DIALOG_FIX_SUPPORT
+        >> newOpts.noDlgFixApps
+#endif
+        >> newOpts.noMenuStripeApps >> newOpts.menubarApps >> newOpts.statusbarApps >> newOpts.useQtFileDialogApps
+        >> newOpts.windowDragWhiteList >> newOpts.windowDragBlackList;
+
+    if(str.status()!=QDataStream::Ok || !str.atEnd())
+        return false;
+
+    // Pixmaps are not part of the snapshot, load them as toAppearance() would have done.
+    newOpts.bgndPixmap.img=QPixmap();
+    newOpts.menuBgndPixmap.img=QPixmap();
+    if(APPEARANCE_FILE==newOpts.bgndAppearance && !newOpts.bgndPixmap.img.load(newOpts.bgndPixmap.file) && checkImages)
+        return false;
+    if(APPEARANCE_FILE==newOpts.menuBgndAppearance && !newOpts.menuBgndPixmap.img.load(newOpts.menuBgndPixmap.file) &&
+       checkImages)
+        return false;
+
+    qtcCheckConfig(&newOpts);
+    *opts=newOpts;
+    return true;
+}
+#endif
+
 #ifdef __cplusplus
 bool qtcReadConfig(const QString &file, Options *opts, Options *defOpts, bool checkImages)
 #else
@@ -1748,6 +2060,12 @@ bool qtcReadConfig(const char *file, Options *opts, Options *defOpts)
     else
     {
 #ifdef __cplusplus
+#ifdef QTC_CONFIG_CACHE
+        bool useCache(!defOpts && !getenv("QTCURVE_NO_CONFIG_CACHE"));
+
+        if(useCache && readConfigCache(file, opts, checkImages))
+            return true;
+#endif
         QtCConfig cfg(file);
 
         if(cfg.ok())
@@ -1954,6 +2272,7 @@ bool qtcReadConfig(const char *file, Options *opts, Options *defOpts)
             CFG_READ_ROUND(round)
             CFG_READ_INT(highlightFactor)
             CFG_READ_INT(menuDelay)
+            CFG_READ_INT(pixmapCacheSize)
             CFG_READ_INT(sliderWidth)
             CFG_READ_INT(tabBgnd)
             CFG_READ_TB_BORDER(toolbarBorders)
@@ -2389,6 +2708,10 @@ bool qtcReadConfig(const char *file, Options *opts, Options *defOpts)
 
             qtcCheckConfig(opts);
 
+#ifdef QTC_CONFIG_CACHE
+            if(useCache)
+                writeConfigCache(file, opts);
+#endif
 #ifndef __cplusplus
             if(!defOpts)
             {
@@ -2480,6 +2803,7 @@ void qtcDefaultSettings(Options *opts)
     opts->splitterHighlight=DEFAULT_SPLITTER_HIGHLIGHT_FACTOR;
     opts->crSize=CR_LARGE_SIZE;
     opts->menuDelay=DEFAULT_MENU_DELAY;
+    opts->pixmapCacheSize=DEFAULT_PIXMAP_CACHE_SIZE;
     opts->sliderWidth=DEFAULT_SLIDER_WIDTH;
     opts->selectionAppearance=APPEARANCE_HARSH_GRADIENT;
     opts->fadeLines=true;
@@ -3260,6 +3584,7 @@ bool qtcWriteConfig(KConfig *cfg, const Options &opts, const Options &def, bool
         CFG_WRITE_ENTRY(round)
         CFG_WRITE_ENTRY_NUM(highlightFactor)
         CFG_WRITE_ENTRY_NUM(menuDelay)
+        CFG_WRITE_ENTRY_NUM(pixmapCacheSize)
         CFG_WRITE_ENTRY_NUM(sliderWidth)
         CFG_WRITE_ENTRY(toolbarBorders)
         CFG_WRITE_APPEARANCE_ENTRY(appearance, APP_ALLOW_BASIC)
@@ -25,6 +25,9 @@ extern void qtcSetBarHidden(const char *app, bool hidden, const char *prefix);
 #endif // __cplusplus
 
 extern void qtcLoadBgndImage(QtCImage *img);
+#ifdef __cplusplus
+extern QImage qtcDecodeBgndImage(const QString &file, int width, int height);
+#endif // __cplusplus
 
 #endif // !defined QT_VERSION || QT_VERSION >= 0x040000)
 
@@ -171,9 +171,6 @@ void QtCurveButton::drawButton(QPainter *painter)
              iconForMenu(TITLEBAR_ICON_MENU_BUTTON==
                             Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_TitleBarIcon, 0L, 0L));
     QColor   buttonColor(KDecoration::options()->color(KDecoration::ColorTitleBar, active));
-    QPixmap  buffer(width(), height());
-    buffer.fill(Qt::transparent);
-    QPainter bP(&buffer);
 #if KDE_IS_VERSION(4, 3, 85)
     bool     isTabClose(ItemCloseButton==type());
 
@@ -241,7 +238,7 @@ void QtCurveButton::drawButton(QPainter *painter)
             if(flags&TITLEBAR_BUTTON_COLOR && !(flags&TITLEBAR_BUTTON_COLOR_SYMBOL))
                 opt.version=versionHack;
         }
-        Handler()->wStyle()->drawPrimitive(QStyle::PE_PanelButtonCommand, &opt, &bP, 0L);
+        Handler()->wStyle()->drawPrimitive(QStyle::PE_PanelButtonCommand, &opt, painter, 0L);
         drewFrame=true;
     }
 
@@ -259,17 +256,17 @@ void QtCurveButton::drawButton(QPainter *painter)
             dY++;
             dX++;
         }
-        bP.drawPixmap(dX, dY, menuIcon);
+        painter->drawPixmap(dX, dY, menuIcon);
     }
     else if(isEnabled() && (!(flags&TITLEBAR_BUTTON_HOVER_SYMBOL_FULL) || sunken || itsHover))
     {
-        const QBitmap &icon(Handler()->buttonBitmap(itsIconType, size(), decoration()->isToolWindow()));
-        bool          customCol(false),
-                      faded(!itsHover && flags&TITLEBAR_BUTTON_HOVER_SYMBOL);
-        QColor        col(KDecoration::options()->color(KDecoration::ColorFont, active/* || faded*/));
-        int           dX(r.x()+(r.width()-icon.width())/2),
-                      dY(r.y()+(r.height()-icon.height())/2);
-        EEffect       effect((EEffect)(style()->pixelMetric((QStyle::PixelMetric)QtC_TitleBarEffect)));
+        QSize   iconSize(Handler()->buttonBitmap(itsIconType, size()).size());
+        bool    customCol(false),
+                faded(!itsHover && flags&TITLEBAR_BUTTON_HOVER_SYMBOL);
+        QColor  col(KDecoration::options()->color(KDecoration::ColorFont, active/* || faded*/));
+        int     dX(r.x()+(r.width()-iconSize.width())/2),
+                dY(r.y()+(r.height()-iconSize.height())/2);
+        EEffect effect((EEffect)(style()->pixelMetric((QStyle::PixelMetric)QtC_TitleBarEffect)));
 
         if(EFFECT_ETCH==effect && drewFrame)
             effect=EFFECT_SHADOW;
@@ -305,8 +302,7 @@ void QtCurveButton::drawButton(QPainter *painter)
             QColor shadow(WINDOW_SHADOW_COLOR(effect));
 
             shadow.setAlphaF(WINDOW_TEXT_SHADOW_ALPHA(effect));
-            bP.setPen(shadow);
-            bP.drawPixmap(EFFECT_SHADOW==effect ? dX+1 : dX, dY+1, icon);
+            painter->drawPixmap(EFFECT_SHADOW==effect ? dX+1 : dX, dY+1, Handler()->buttonIcon(itsIconType, size(), shadow));
         }
 
         if(itsHover && !sunken && !(flags&TITLEBAR_BUTTON_COLOR) && !customCol)
@@ -326,12 +322,8 @@ void QtCurveButton::drawButton(QPainter *painter)
         else // If dont set an alpha level here, then (at least on intel) the background colour is used!
             col.setAlpha(254);
 
-        bP.setPen(col);
-        bP.drawPixmap(dX, dY, icon);
+        painter->drawPixmap(dX, dY, Handler()->buttonIcon(itsIconType, size(), col));
     }
-
-    bP.end();
-    painter->drawPixmap(0, 0, buffer);
 }
 
 QBitmap IconEngine::icon(ButtonIcon icon, int size, QStyle *style)
@@ -130,7 +130,7 @@ int getOpacityProperty(WId wId)
     return o<0 || o>100 ? 100 : o;
 }
 
-void getBgndSettings(WId wId, EAppearance &app, QColor &col)
+bool getBgndSettings(WId wId, EAppearance &app, QColor &col)
 {
     static const Atom constAtom = XInternAtom(QX11Info::display(), BGND_ATOM, False);
 
@@ -146,9 +146,11 @@ void getBgndSettings(WId wId, EAppearance &app, QColor &col)
         col.setRgb((val&0xFF000000)>>24, (val&0x00FF0000)>>16, (val&0x0000FF00)>>8);
 
         XFree(data);
+        return true;
     }
     //else
     //    *data = NULL; // superflous?!?
+    return false;
 }
 
 static QPainterPath createPath(const QRectF &r, double radiusTop, double radiusBot)
@@ -276,6 +278,15 @@ QtCurveClient::QtCurveClient(KDecorationBridge *bridge, QtCurveHandler *factory)
              , itsMenuBarSize(-1)
              , itsToggleMenuBarButton(0L)
              , itsToggleStatusBarButton(0L)
+             , itsStaleProperties(PROP_ALL)
+             , itsOpacityProp(100)
+             , itsMenuBarSizeProp(-1)
+             , itsStatusBarProp(-1)
+             , itsBgndAppearance(APPEARANCE_FLAT)
+             , itsHaveBgndProp(false)
+             , itsCheckMenuBarSize(true)
+             , itsMaskRound(-1)
+             , itsMaskRoundBottom(false)
 //              , itsHover(false)
 #if KDE_IS_VERSION(4, 3, 85) && !KDE_IS_VERSION(4, 8, 80)
              , itsClickInProgress(false)
@@ -523,12 +534,12 @@ void QtCurveClient::paintEvent(QPaintEvent *e)
     QPainter             painter(widget());
     QRect                r(widget()->rect());
     QStyleOptionTitleBar opt;
-    int                  windowBorder(Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_WindowBorder, 0L, 0L));
+    int                  windowBorder(Handler()->styleMetric(QtC_WindowBorder));
     bool                 active(isActive()),
                          colorTitleOnly(windowBorder&WINDOW_BORDER_COLOR_TITLEBAR_ONLY),
                          roundBottom(Handler()->roundBottom()),
                          preview(isPreview()),
-                         blend(!preview && Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_BlendMenuAndTitleBar, NULL, NULL)),
+                         blend(!preview && Handler()->styleMetric(QtC_BlendMenuAndTitleBar)),
                          menuColor(windowBorder&WINDOW_BORDER_USE_MENUBAR_COLOR_FOR_TITLEBAR),
                          separator(active && windowBorder&WINDOW_BORDER_SEPARATOR),
                          maximized(isMaximized());
@@ -541,15 +552,25 @@ void QtCurveClient::paintEvent(QPaintEvent *e)
                          titleEdgeLeft(layoutMetric(LM_TitleEdgeLeft)),
                          titleEdgeRight(layoutMetric(LM_TitleEdgeRight)),
                          titleBarHeight(titleHeight+titleEdgeTop+titleEdgeBottom+(isMaximized() ? border : 0)),
-                         round=Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_Round, NULL, NULL),
-                         buttonFlags=Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_TitleBarButtons, NULL, NULL);
+                         round=Handler()->styleMetric(QtC_Round),
+                         buttonFlags=Handler()->styleMetric(QtC_TitleBarButtons);
     int                  rectX, rectY, rectX2, rectY2, shadowSize(0),
                          kwinOpacity(compositing ? Handler()->opacity(active) : 100),
                          opacity(kwinOpacity);
     EAppearance          bgndAppearance=APPEARANCE_FLAT;
     QColor               windowCol(widget()->palette().color(QPalette::Window));
 
-    getBgndSettings(windowId(), bgndAppearance, windowCol);
+    if(itsStaleProperties&PROP_BGND)
+    {
+        itsHaveBgndProp=getBgndSettings(windowId(), bgndAppearance, itsBgndColor);
+        itsBgndAppearance=bgndAppearance;
+        itsStaleProperties&=~PROP_BGND;
+    }
+    if(itsHaveBgndProp)
+    {
+        bgndAppearance=(EAppearance)itsBgndAppearance;
+        windowCol=itsBgndColor;
+    }
 
     QColor               col(KDecoration::options()->color(KDecoration::ColorTitleBar, active)),
                          fillCol(colorTitleOnly ? windowCol : col);
@@ -567,7 +588,7 @@ void QtCurveClient::paintEvent(QPaintEvent *e)
     painter.setClipRegion(e->region());
 
     if(!preview && compositing && 100==opacity)
-        opacity=getOpacityProperty(windowId());
+        opacity=property(PROP_OPACITY);
 
 #if KDE_IS_VERSION(4, 3, 0)
     if(customShadows)
@@ -600,9 +621,12 @@ void QtCurveClient::paintEvent(QPaintEvent *e)
 
     r.getCoords(&rectX, &rectY, &rectX2, &rectY2);
 
-    if(!preview && (blend||menuColor) && -1==itsMenuBarSize)
+    // Only need to look at the class and property again once the property has changed
+    if(!preview && (blend||menuColor) && -1==itsMenuBarSize && itsCheckMenuBarSize)
     {
         QString wc(windowClass());
+
+        itsCheckMenuBarSize=false;
         if(wc==QLatin1String("W Navigator Firefox browser") ||
            wc==QLatin1String("W Navigator Firefox view-source") ||
            wc==QLatin1String("W Mail Thunderbird 3pane") ||
@@ -625,15 +649,15 @@ void QtCurveClient::paintEvent(QPaintEvent *e)
             itsMenuBarSize=QFontMetrics(QApplication::font()).height()+7;
         else
         {
-            int val=getMenubarSizeProperty(windowId());
+            int val=property(PROP_MENU_SIZE);
             if(val>-1)
                 itsMenuBarSize=val;
         }
     }
 
     if(menuColor && itsMenuBarSize>0 &&
-       (active || !Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_ShadeMenubarOnlyWhenActive, NULL, NULL)))
-        col=QColor(QRgb(Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_MenubarColor, NULL, NULL)));
+       (active || !Handler()->styleMetric(QtC_ShadeMenubarOnlyWhenActive)))
+        col=QColor(QRgb(Handler()->styleMetric(QtC_MenubarColor)));
 
     if(opacity<100)
     {
@@ -748,18 +772,29 @@ void QtCurveClient::paintEvent(QPaintEvent *e)
         if(!compositing && !preview)
         {
             // For some reason, on Jaunty drawing directly is *hideously* slow on intel graphics card!
-            QPixmap pix(32, 32);
-            pix.fill(Qt::transparent);
-            QPainter p2(&pix);
-            p2.setRenderHint(QPainter::Antialiasing, true);
-            opt.rect=QRect(0, 0, pix.width(), pix.height());
-            Handler()->wStyle()->drawPrimitive(QStyle::PE_FrameWindow, &opt, &p2, widget());
-            p2.end();
-            painter.drawTiledPixmap(r.x(), r.y()+10, 2, r.height()-18, pix.copy(0, 8, 2, 16));
-            painter.drawTiledPixmap(r.x()+r.width()-2, r.y()+8, 2, r.height()-16, pix.copy(pix.width()-2, 8, 2, 16));
-            painter.drawTiledPixmap(r.x()+8, r.y()+r.height()-2, r.width()-16, 2, pix.copy(8, pix.height()-2, 16, 2));
-            painter.drawPixmap(r.x(), r.y()+r.height()-8, pix.copy(0, 24, 8, 8));
-            painter.drawPixmap(r.x()+r.width()-8, r.y()+r.height()-8, pix.copy(24, 24, 8, 8));
+            FrameTiles &tiles(itsBorderTiles[active ? 1 : 0]);
+
+            if(!tiles.matches(opt, 32))
+            {
+                QPixmap pix(32, 32);
+                pix.fill(Qt::transparent);
+                QPainter p2(&pix);
+                p2.setRenderHint(QPainter::Antialiasing, true);
+                opt.rect=QRect(0, 0, pix.width(), pix.height());
+                Handler()->wStyle()->drawPrimitive(QStyle::PE_FrameWindow, &opt, &p2, widget());
+                p2.end();
+                tiles.set(opt, 32);
+                tiles.pix[0]=pix.copy(0, 8, 2, 16);
+                tiles.pix[1]=pix.copy(pix.width()-2, 8, 2, 16);
+                tiles.pix[2]=pix.copy(8, pix.height()-2, 16, 2);
+                tiles.pix[3]=pix.copy(0, 24, 8, 8);
+                tiles.pix[4]=pix.copy(24, 24, 8, 8);
+            }
+            painter.drawTiledPixmap(r.x(), r.y()+10, 2, r.height()-18, tiles.pix[0]);
+            painter.drawTiledPixmap(r.x()+r.width()-2, r.y()+8, 2, r.height()-16, tiles.pix[1]);
+            painter.drawTiledPixmap(r.x()+8, r.y()+r.height()-2, r.width()-16, 2, tiles.pix[2]);
+            painter.drawPixmap(r.x(), r.y()+r.height()-8, tiles.pix[3]);
+            painter.drawPixmap(r.x()+r.width()-8, r.y()+r.height()-8, tiles.pix[4]);
         }
         else
 #endif
@@ -794,17 +829,29 @@ void QtCurveClient::paintEvent(QPaintEvent *e)
 #ifdef DRAW_INTO_PIXMAPS
     if(!compositing && !preview && !customBgnd)
     {
-        QPixmap  tPix(32, titleBarHeight+(!blend || itsMenuBarSize<0 ? 0 : itsMenuBarSize));
-        QPainter tPainter(&tPix);
-        tPainter.setRenderHint(QPainter::Antialiasing, true);
+        FrameTiles &tiles(itsTitleTiles[active ? 1 : 0]);
+        int        tHeight(titleBarHeight+(!blend || itsMenuBarSize<0 ? 0 : itsMenuBarSize));
+
         if(!customBgnd)
             opt.state|=QtC_StateKWinFillBgnd;
-        opt.rect=QRect(0, 0, tPix.width(), tPix.height());
-        Handler()->wStyle()->drawComplexControl(QStyle::CC_TitleBar, &opt, &tPainter, widget());
-        tPainter.end();
-        painter.drawTiledPixmap(r.x()+12, r.y(), r.width()-24, tPix.height(), tPix.copy(8, 0, 16, tPix.height()));
-        painter.drawPixmap(r.x(), r.y(), tPix.copy(0, 0, 16, tPix.height()));
-        painter.drawPixmap(r.x()+r.width()-16, r.y(), tPix.copy(tPix.width()-16, 0, 16, tPix.height()));
+        // Only need to render the titlebar again when its height, state or colours change - not on every
+        // caption change, hover or resize.
+        if(!tiles.matches(opt, tHeight))
+        {
+            QPixmap  tPix(32, tHeight);
+            QPainter tPainter(&tPix);
+            tPainter.setRenderHint(QPainter::Antialiasing, true);
+            opt.rect=QRect(0, 0, tPix.width(), tPix.height());
+            Handler()->wStyle()->drawComplexControl(QStyle::CC_TitleBar, &opt, &tPainter, widget());
+            tPainter.end();
+            tiles.set(opt, tHeight);
+            tiles.pix[0]=tPix.copy(8, 0, 16, tPix.height());
+            tiles.pix[1]=tPix.copy(0, 0, 16, tPix.height());
+            tiles.pix[2]=tPix.copy(tPix.width()-16, 0, 16, tPix.height());
+        }
+        painter.drawTiledPixmap(r.x()+12, r.y(), r.width()-24, tHeight, tiles.pix[0]);
+        painter.drawPixmap(r.x(), r.y(), tiles.pix[1]);
+        painter.drawPixmap(r.x()+r.width()-16, r.y(), tiles.pix[2]);
     }
     else
 #endif
@@ -836,7 +883,7 @@ void QtCurveClient::paintEvent(QPaintEvent *e)
              vOffset=hOffset+(outerBorder ? 1 :0),
              posAdjust=maximized || outerBorder ? 2 : 0,
              edgePad=Handler()->edgePad();
-        bool menuIcon=TITLEBAR_ICON_MENU_BUTTON==Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_TitleBarIcon, 0L, 0L),
+        bool menuIcon=TITLEBAR_ICON_MENU_BUTTON==Handler()->styleMetric(QtC_TitleBarIcon),
              menuOnlyLeft=menuIcon && onlyMenuIcon(true),
              menuOnlyRight=menuIcon && !menuOnlyLeft && onlyMenuIcon(false);
 
@@ -849,8 +896,8 @@ void QtCurveClient::paintEvent(QPaintEvent *e)
                                             buttonsRightWidth(), titleBarHeight-2*(vOffset+edgePad)), col, buttonFlags&TITLEBAR_BUTTON_ROUND, round);
     }
 
-    bool showIcon=TITLEBAR_ICON_NEXT_TO_TITLE==Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_TitleBarIcon,  0L, 0L);
-    int  iconSize=showIcon ? Handler()->wStyle()->pixelMetric(QStyle::PM_SmallIconSize) : 0;
+    bool showIcon=TITLEBAR_ICON_NEXT_TO_TITLE==Handler()->styleMetric(QtC_TitleBarIcon);
+    int  iconSize=showIcon ? Handler()->styleMetric(QStyle::PM_SmallIconSize) : 0;
 
 #if KDE_IS_VERSION(4, 3, 85) && !KDE_IS_VERSION(4, 8, 80)
     QList<ClientGroupItem> tabList  = clientGroupItems();
@@ -935,13 +982,13 @@ void QtCurveClient::paintEvent(QPaintEvent *e)
 #endif
 
     bool hideToggleButtons(true);
-    int  toggleButtons(Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_ToggleButtons, NULL, NULL));
+    int  toggleButtons(Handler()->styleMetric(QtC_ToggleButtons));
 
     if(toggleButtons)
     {
-        if(!itsToggleMenuBarButton && toggleButtons&0x01 && (Handler()->wasLastMenu(windowId()) || getMenubarSizeProperty(windowId())>-1))
+        if(!itsToggleMenuBarButton && toggleButtons&0x01 && (Handler()->wasLastMenu(windowId()) || property(PROP_MENU_SIZE)>-1))
             itsToggleMenuBarButton=createToggleButton(true);
-        if(!itsToggleStatusBarButton && toggleButtons&0x02 && (Handler()->wasLastStatus(windowId()) || getStatusbarSizeProperty(windowId())>-1))
+        if(!itsToggleStatusBarButton && toggleButtons&0x02 && (Handler()->wasLastStatus(windowId()) || property(PROP_STATUSBAR)>-1))
             itsToggleStatusBarButton=createToggleButton(false);
 
     //     if(itsHover)
@@ -956,7 +1003,7 @@ void QtCurveClient::paintEvent(QPaintEvent *e)
                     (itsToggleMenuBarButton ? itsToggleMenuBarButton->width() : 0) +
                     (itsToggleStatusBarButton ? itsToggleStatusBarButton->width() : 0)) < r.width())
                 {
-                    int  align(Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_TitleAlignment, 0L, 0L));
+                    int  align(Handler()->styleMetric(QtC_TitleAlignment));
                     bool onLeft(align&Qt::AlignRight);
 
                     if(align&Qt::AlignHCenter)
@@ -1005,7 +1052,7 @@ void QtCurveClient::paintEvent(QPaintEvent *e)
     if(separator)
     {
         QColor        color(KDecoration::options()->color(KDecoration::ColorFont, isActive()));
-        Qt::Alignment align((Qt::Alignment)Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_TitleAlignment, 0L, 0L));
+        Qt::Alignment align((Qt::Alignment)Handler()->styleMetric(QtC_TitleAlignment));
 
         r.adjust(16, titleBarHeight-1, -16, 0);
         color.setAlphaF(0.5);
@@ -1028,7 +1075,7 @@ void QtCurveClient::paintTitle(QPainter *painter, const QRect &capRect, const QR
         QFontMetrics  fm(painter->fontMetrics());
         QString       str(fm.elidedText(cap, Qt::ElideRight,
                             capRect.width()-(showIcon ? pix.width()+constTitlePad : 0), QPalette::WindowText));
-        Qt::Alignment hAlign((Qt::Alignment)Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_TitleAlignment, 0L, 0L)),
+        Qt::Alignment hAlign((Qt::Alignment)Handler()->styleMetric(QtC_TitleAlignment)),
                       alignment(Qt::AlignVCenter|hAlign);
         bool          alignFull(!isTab && Qt::AlignHCenter==hAlign),
                       reverse=Qt::RightToLeft==QApplication::layoutDirection(),
@@ -1036,7 +1083,7 @@ void QtCurveClient::paintTitle(QPainter *painter, const QRect &capRect, const QR
         QRect         textRect(alignFull ? alignFullRect : capRect);
         int           textWidth=alignFull || (showIcon && alignment&Qt::AlignHCenter)
                                     ? fm.boundingRect(str).width()+(showIcon ? pix.width()+constTitlePad : 0) : 0;
-        EEffect       effect((EEffect)(Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_TitleBarEffect)));
+        EEffect       effect((EEffect)(Handler()->styleMetric(QtC_TitleBarEffect)));
 
         if(alignFull)
         {
@@ -1166,11 +1213,26 @@ void QtCurveClient::updateWindowShape()
 #endif
                       widget()->rect());
 
-        setMask(getMask(Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_Round, NULL, NULL), r));
+        setMask(getMask(Handler()->styleMetric(QtC_Round), r));
     }
 }
 
 QRegion QtCurveClient::getMask(int round, const QRect &r) const
+{
+    // Called on every resize, and twice per paint, so keep the last one (at the origin)
+    bool roundBottom(!isShade() && Handler()->roundBottom());
+
+    if(round!=itsMaskRound || roundBottom!=itsMaskRoundBottom || r.size()!=itsMaskSize)
+    {
+        itsMask=createMask(round, QRect(QPoint(0, 0), r.size()));
+        itsMaskRound=round;
+        itsMaskRoundBottom=roundBottom;
+        itsMaskSize=r.size();
+    }
+    return itsMask.translated(r.topLeft());
+}
+
+QRegion QtCurveClient::createMask(int round, const QRect &r) const
 {
     int x, y, w, h;
 
@@ -1429,8 +1491,8 @@ bool QtCurveClient::mouseMoveEvent(QMouseEvent *e)
         pix.fill(Qt::transparent);
         QPainter painter(&pix);
 
-        bool  showIcon=TITLEBAR_ICON_NEXT_TO_TITLE==Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_TitleBarIcon,  0L, 0L);
-        int   iconSize=showIcon ? Handler()->wStyle()->pixelMetric(QStyle::PM_SmallIconSize) : 0;
+        bool  showIcon=TITLEBAR_ICON_NEXT_TO_TITLE==Handler()->styleMetric(QtC_TitleBarIcon);
+        int   iconSize=showIcon ? Handler()->styleMetric(QStyle::PM_SmallIconSize) : 0;
         QRect r(0, 0, geom.size().width()-(tabList.count() ? (TAB_CLOSE_ICON_SIZE+constTitlePad) : 0), geom.size().height());
 
         painter.save();
@@ -1581,6 +1643,9 @@ int QtCurveClient::itemClicked(const QPoint &point, bool between, bool drag)
 
 void QtCurveClient::reset(unsigned long changed)
 {
+    itsStaleProperties=PROP_ALL;
+    itsCheckMenuBarSize=true;
+
 #if KDE_IS_VERSION(4, 3, 85) && !KDE_IS_VERSION(4, 8, 80)
     if(changed & SettingCompositing)
     {
@@ -1593,6 +1658,11 @@ void QtCurveClient::reset(unsigned long changed)
         // Reset button backgrounds...
         for(int i=0; i<constNumButtonStates; ++i)
            itsButtonBackground[i].pix=QPixmap();
+        for(int i=0; i<2; ++i)
+        {
+            itsBorderTiles[i]=FrameTiles();
+            itsTitleTiles[i]=FrameTiles();
+        }
     }
 
     if (changed&SettingBorder)
@@ -1664,7 +1734,7 @@ void QtCurveClient::informAppOfBorderSizeChanges()
 
 void QtCurveClient::informAppOfActiveChange()
 {
-    if(Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_ShadeMenubarOnlyWhenActive, NULL, NULL))
+    if(Handler()->styleMetric(QtC_ShadeMenubarOnlyWhenActive))
     {
         static const Atom constQtCActiveWindow = XInternAtom(QX11Info::display(), ACTIVE_WINDOW_ATOM, False);
 
@@ -1682,7 +1752,7 @@ void QtCurveClient::informAppOfActiveChange()
 
 void QtCurveClient::sendToggleToApp(bool menubar)
 {
-    //if(Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_ShadeMenubarOnlyWhenActive, NULL, NULL))
+    //if(Handler()->styleMetric(QtC_ShadeMenubarOnlyWhenActive))
     {
         static const Atom constQtCToggleMenuBar   = XInternAtom(QX11Info::display(), TOGGLE_MENUBAR_ATOM, False);
         static const Atom constQtCToggleStatusBar = XInternAtom(QX11Info::display(), TOGGLE_STATUSBAR_ATOM, False);
@@ -1703,6 +1773,33 @@ void QtCurveClient::sendToggleToApp(bool menubar)
     }
 }
 
+int QtCurveClient::property(unsigned int prop)
+{
+    int *val=PROP_OPACITY==prop ? &itsOpacityProp : PROP_MENU_SIZE==prop ? &itsMenuBarSizeProp : &itsStatusBarProp;
+
+    if(itsStaleProperties&prop)
+    {
+        *val=PROP_OPACITY==prop
+                ? getOpacityProperty(windowId())
+                : PROP_MENU_SIZE==prop
+                    ? getMenubarSizeProperty(windowId())
+                    : getStatusbarSizeProperty(windowId());
+        itsStaleProperties&=~prop;
+    }
+    return *val;
+}
+
+void QtCurveClient::propertyChanged(QtCurveHandler::ClientProperty p)
+{
+    // The PROP_* flags are in the order of QtCurveHandler::ClientProperty
+    unsigned int prop(1<<p);
+
+    itsStaleProperties|=prop;
+    if(PROP_MENU_SIZE==prop)
+        itsCheckMenuBarSize=true;
+    widget()->update();
+}
+
 const QString & QtCurveClient::windowClass()
 {
     if(itsWindowClass.isEmpty())
@@ -1729,7 +1826,7 @@ const QString & QtCurveClient::windowClass()
 void QtCurveClient::menuBarSize(int size)
 {
     itsMenuBarSize=size;
-    if(Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_ToggleButtons, NULL, NULL) &0x01)
+    if(Handler()->styleMetric(QtC_ToggleButtons) &0x01)
     {
         if(!itsToggleMenuBarButton)
             itsToggleMenuBarButton=createToggleButton(true);
@@ -1742,7 +1839,7 @@ void QtCurveClient::menuBarSize(int size)
 void QtCurveClient::statusBarState(bool state)
 {
     Q_UNUSED(state)
-    if(Handler()->wStyle()->pixelMetric((QStyle::PixelMetric)QtC_ToggleButtons, NULL, NULL) &0x02)
+    if(Handler()->styleMetric(QtC_ToggleButtons) &0x02)
     {
         if(!itsToggleStatusBarButton)
             itsToggleStatusBarButton=createToggleButton(false);
@@ -39,6 +39,8 @@
 #endif
 #include <QtGui/QPixmap>
 #include <QtGui/QColor>
+#include <QtGui/QRegion>
+#include <QtGui/QStyleOption>
 #include "qtcurvehandler.h"
 
 namespace KWinQtCurve
@@ -79,6 +81,7 @@ class QtCurveClient :
                                          bool isTab=false, bool activeTab=false);
     void                      updateWindowShape();
     QRegion                   getMask(int round, const QRect &r) const;
+    QRegion                   createMask(int round, const QRect &r) const;
     void                      updateCaption();
     bool                      eventFilter(QObject *o, QEvent *e);
     bool isMaximized() const { return maximizeMode()==MaximizeFull && !options()->moveResizeMaximizedWindows();  }
@@ -87,6 +90,7 @@ class QtCurveClient :
     QtCurveToggleButton *     createToggleButton(bool menubar);
     void                      informAppOfBorderSizeChanges();
     void                      sendToggleToApp(bool menubar);
+    void                      propertyChanged(QtCurveHandler::ClientProperty prop);
 
     public Q_SLOTS:
 
@@ -112,9 +116,21 @@ class QtCurveClient :
     void                      deleteSizeGrip();
     void                      informAppOfActiveChange();
     const QString &           windowClass();
+    int                       property(unsigned int prop);
 
     private:
 
+    // X properties set by the style on the client window, only read again
+    // after a PropertyNotify (or a reset).
+    enum
+    {
+        PROP_BGND      = 0x01,
+        PROP_OPACITY   = 0x02,
+        PROP_MENU_SIZE = 0x04,
+        PROP_STATUSBAR = 0x08,
+        PROP_ALL       = 0x0F
+    };
+
     struct ButtonBgnd
     {
         QPixmap pix;
@@ -124,6 +140,38 @@ class QtCurveClient :
 
     static const int constNumButtonStates=2;
 
+    // Pieces of the border or titlebar, as rendered (non-compositing only) for the given state and colours
+    struct FrameTiles
+    {
+        FrameTiles() : state(0), version(0), height(0), button(0), window(0), shadow(0) { }
+
+        bool matches(const QStyleOption &opt, int h) const
+        {
+            return !pix[0].isNull() && h==height && opt.state==state && opt.version==version &&
+                   opt.palette.color(QPalette::Button).rgba()==button &&
+                   opt.palette.color(QPalette::Window).rgba()==window &&
+                   opt.palette.color(QPalette::Shadow).rgba()==shadow;
+        }
+
+        void set(const QStyleOption &opt, int h)
+        {
+            state=opt.state;
+            version=opt.version;
+            height=h;
+            button=opt.palette.color(QPalette::Button).rgba();
+            window=opt.palette.color(QPalette::Window).rgba();
+            shadow=opt.palette.color(QPalette::Shadow).rgba();
+        }
+
+        QPixmap pix[5];
+        uint    state;
+        int     version,
+                height;
+        QRgb    button,
+                window,
+                shadow;
+    };
+
     QtCurveSizeGrip        *itsResizeGrip;
     ButtonBgnd             itsButtonBackground[constNumButtonStates];
     QRect                  itsCaptionRect;
@@ -133,6 +181,20 @@ class QtCurveClient :
     int                    itsMenuBarSize;
     QtCurveToggleButton    *itsToggleMenuBarButton,
                            *itsToggleStatusBarButton;
+    unsigned int           itsStaleProperties;
+    int                    itsOpacityProp,
+                           itsMenuBarSizeProp,
+                           itsStatusBarProp,
+                           itsBgndAppearance;
+    QColor                 itsBgndColor;
+    bool                   itsHaveBgndProp,
+                           itsCheckMenuBarSize;
+    FrameTiles             itsBorderTiles[2],
+                           itsTitleTiles[2];
+    mutable QRegion        itsMask;
+    mutable QSize          itsMaskSize;
+    mutable int            itsMaskRound;
+    mutable bool           itsMaskRoundBottom;
 //     bool                   itsHover;
 #if KDE_IS_VERSION(4, 3, 85) && !KDE_IS_VERSION(4, 8, 80)
     QList<QtCurveButton *> itsCloseButtons;
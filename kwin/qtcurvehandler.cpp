@@ -34,6 +34,8 @@
 #include <QFile>
 #include <QTextStream>
 #include <QApplication>
+#include <QAbstractEventDispatcher>
+#include <QX11Info>
 #include <QDBusConnection>
 #include <QDBusMessage>
 #include "qtcurvehandler.h"
@@ -51,6 +53,8 @@
 #include <sys/types.h>
 #include <kde_file.h>
 #include "common.h"
+#include <X11/Xlib.h>
+#include "../style/fixx11h.h"
 
 static time_t getTimeStamp(const QString &item)
 {
@@ -93,22 +97,45 @@ QtCurveHandler * Handler()
     return handler;
 }
 
+static QAbstractEventDispatcher::EventFilter prevEventFilter = 0;
+
+// The style stores the window's background, opacity, etc. as properties on the client window. Watch for changes here,
+// so that the clients do not need to read them on every repaint.
+static bool propertyEventFilter(void *message)
+{
+    XEvent *event=(XEvent *)message;
+
+    if(handler && PropertyNotify==event->type)
+        handler->propertyChanged(event->xproperty.window, event->xproperty.atom);
+    return prevEventFilter ? prevEventFilter(message) : false;
+}
+
 QtCurveHandler::QtCurveHandler()
               : itsLastMenuXid(0)
               , itsLastStatusXid(0)
               , itsStyle(NULL)
               , itsDBus(NULL)
 {
+    static const char * constPropertyAtomNames[NumClientProperties]={ BGND_ATOM, OPACITY_ATOM, MENU_SIZE_ATOM, STATUSBAR_ATOM };
+    Atom                atoms[NumClientProperties];
+
     handler=this;
+    XInternAtoms(QX11Info::display(), (char **)constPropertyAtomNames, NumClientProperties, False, atoms);
+    for(int i=0; i<NumClientProperties; ++i)
+        itsPropertyAtoms[i]=atoms[i];
+    itsButtonIcons.setMaxCost(256);
     setStyle();
     reset(0);
 
     itsDBus=new QtCurveDBus(this);
     QDBusConnection::sessionBus().registerObject("/QtCurve", this);
+    prevEventFilter=QAbstractEventDispatcher::instance()->setEventFilter(propertyEventFilter);
 }
 
 QtCurveHandler::~QtCurveHandler()
 {
+    QAbstractEventDispatcher::instance()->setEventFilter(prevEventFilter);
+    prevEventFilter=0;
     handler=0;
     delete itsStyle;
 }
@@ -148,6 +175,8 @@ void QtCurveHandler::setStyle()
 bool QtCurveHandler::reset(unsigned long changed)
 {
     bool styleChanged=false;
+
+    itsStyleMetrics.clear();
     if(abs(itsTimeStamp-getTimeStamp(xdgConfigFolder()+"/qtcurve/stylerc"))>2)
     {
         delete itsStyle;
@@ -173,9 +202,8 @@ bool QtCurveHandler::reset(unsigned long changed)
 
     setBorderSize();
 
-    for (int t=0; t < 2; ++t)
-        for (int i=0; i < NumButtonIcons; i++)
-            itsBitmaps[t][i]=QPixmap();
+    itsBitmaps.clear();
+    itsButtonIcons.clear();
 
     // Do we need to "hit the wooden hammer" ?
     bool needHardReset = true;
@@ -393,17 +421,52 @@ bool QtCurveHandler::readConfig(bool compositingToggled)
            itsConfig!=oldConfig;
 }
 
-const QBitmap & QtCurveHandler::buttonBitmap(ButtonIcon type, const QSize &size, bool toolWindow)
+static inline quint32 buttonKey(ButtonIcon type, const QSize &size)
 {
-    int typeIndex(type),
-        reduceW(size.width()>14 ? static_cast<int>((2.0*(size.width()/3.5))+0.5) : 6),
-        reduceH(size.height()>14 ? static_cast<int>((2.0*(size.height()/3.5))+0.5) : 6),
-        w(size.width() - reduceW),
-        h(size.height() - reduceH);
-
-    if (itsBitmaps[toolWindow][typeIndex].size()!=QSize(w,h))
-        itsBitmaps[toolWindow][typeIndex] = IconEngine::icon(type /*icon*/, qMin(w, h), wStyle());
-    return itsBitmaps[toolWindow][typeIndex];
+    return ((quint32)(size.width()&0xFFF)<<20)|((quint32)(size.height()&0xFFF)<<8)|(type&0xFF);
+}
+
+QBitmap QtCurveHandler::buttonBitmap(ButtonIcon type, const QSize &size)
+{
+    quint32 key(buttonKey(type, size));
+    QBitmap *bitmap(itsBitmaps.object(key));
+
+    if(!bitmap)
+    {
+        int reduceW(size.width()>14 ? static_cast<int>((2.0*(size.width()/3.5))+0.5) : 6),
+            reduceH(size.height()>14 ? static_cast<int>((2.0*(size.height()/3.5))+0.5) : 6),
+            w(size.width() - reduceW),
+            h(size.height() - reduceH);
+
+        bitmap=new QBitmap(IconEngine::icon(type /*icon*/, qMin(w, h), wStyle()));
+        itsBitmaps.insert(key, bitmap);
+    }
+    return *bitmap;
+}
+
+// The icon bitmap painted in col, shared by all buttons of the same size. As
+// the colour already includes the hover, sunken and faded states the buttons
+// can blit these directly.
+QPixmap QtCurveHandler::buttonIcon(ButtonIcon type, const QSize &size, const QColor &col)
+{
+    quint64 key(((quint64)col.rgba()<<32)|buttonKey(type, size));
+    QPixmap *icon(itsButtonIcons.object(key));
+
+    if(!icon)
+    {
+        QBitmap bitmap(buttonBitmap(type, size));
+        QImage  img(bitmap.size(), QImage::Format_ARGB32_Premultiplied);
+
+        img.fill(0);
+
+        QPainter p(&img);
+        p.setPen(col);
+        p.drawPixmap(0, 0, bitmap);
+        p.end();
+        icon=new QPixmap(QPixmap::fromImage(img));
+        itsButtonIcons.insert(key, icon);
+    }
+    return *icon;
 }
 
 int QtCurveHandler::borderSize(bool bot) const
@@ -478,6 +541,41 @@ int QtCurveHandler::borderEdgeSize() const
                     : 1);
 }
 
+int QtCurveHandler::styleMetric(int metric) const
+{
+    QHash<int, int>::ConstIterator it(itsStyleMetrics.constFind(metric));
+
+    if(it!=itsStyleMetrics.constEnd())
+        return *it;
+
+    int val(wStyle()->pixelMetric((QStyle::PixelMetric)metric, 0L, 0L));
+
+    itsStyleMetrics.insert(metric, val);
+    return val;
+}
+
+void QtCurveHandler::propertyChanged(unsigned long xid, unsigned long atom)
+{
+    // Called for every property change in the session, most of which are of
+    // no interest (e.g. _NET_WM_USER_TIME), so check the atom first.
+    int prop(0);
+
+    while(prop<NumClientProperties && itsPropertyAtoms[prop]!=atom)
+        ++prop;
+    if(NumClientProperties==prop)
+        return;
+
+    QList<QtCurveClient *>::ConstIterator it(itsClients.begin()),
+                                          end(itsClients.end());
+
+    for(; it!=end; ++it)
+        if((*it)->windowId()==xid)
+        {
+            (*it)->propertyChanged((ClientProperty)prop);
+            break;
+        }
+}
+
 void QtCurveHandler::removeClient(QtCurveClient *c)
 {
     if(c->windowId()==itsLastMenuXid)
@@ -30,6 +30,8 @@
 #include <QtGui/QFont>
 #include <QtGui/QApplication>
 #include <QtGui/QBitmap>
+#include <QtCore/QHash>
+#include <QtCore/QCache>
 #include <kdeversion.h>
 #include <kdecoration.h>
 #include <kdecorationfactory.h>
@@ -81,6 +83,17 @@ class QtCurveHandler : public QObject,
 
     public:
 
+    // X properties the style sets on the client windows, in the order of the
+    // QtCurveClient::PROP_* flags.
+    enum ClientProperty
+    {
+        PropBgnd,
+        PropOpacity,
+        PropMenuSize,
+        PropStatusBar,
+        NumClientProperties
+    };
+
     QtCurveHandler();
     ~QtCurveHandler();
     void setStyle();
@@ -90,7 +103,8 @@ class QtCurveHandler : public QObject,
     virtual KDecoration * createDecoration(KDecorationBridge *);
     virtual bool supports(Ability ability) const;
 
-    const QBitmap &       buttonBitmap(ButtonIcon type, const QSize &size, bool toolWindow);
+    QBitmap               buttonBitmap(ButtonIcon type, const QSize &size);
+    QPixmap               buttonIcon(ButtonIcon type, const QSize &size, const QColor &col);
     int                   titleHeight() const        { return itsTitleHeight; }
     int                   titleHeightTool() const    { return itsTitleHeightTool; }
     const QFont &         titleFont()                { return itsTitleFont; }
@@ -102,6 +116,7 @@ class QtCurveHandler : public QObject,
     QtCurveConfig::Shade  outerBorder() const        { return itsConfig.outerBorder(); }
     QtCurveConfig::Shade  innerBorder() const        { return itsConfig.innerBorder(); }
     QStyle *              wStyle() const             { return itsStyle ? itsStyle : QApplication::style(); }
+    int                   styleMetric(int metric) const;
     int                   borderEdgeSize() const;
     int                   titleBarPad() const        { return itsConfig.titleBarPad(); }
     int                   edgePad() const            { return itsConfig.edgePad(); }
@@ -122,6 +137,7 @@ class QtCurveHandler : public QObject,
     void                  borderSizeChanged();
     void                  addClient(QtCurveClient *c)    { itsClients.append(c); }
     void                  removeClient(QtCurveClient *c);
+    void                  propertyChanged(unsigned long xid, unsigned long atom);
     bool                  wasLastMenu(unsigned int id)   { return id==itsLastMenuXid; }
     bool                  wasLastStatus(unsigned int id) { return id==itsLastStatusXid; }
     const QColor &        hoverCol(bool active)          { return itsHoverCols[active ? 1 : 0]; }
@@ -142,11 +158,16 @@ class QtCurveHandler : public QObject,
     QFont                  itsTitleFont,
                            itsTitleFontTool;
     QStyle                 *itsStyle;
-    QBitmap                itsBitmaps[2][NumButtonIcons];
+    // Keyed on button size and icon type, the coloured icons also on the rgba
+    QCache<quint32, QBitmap> itsBitmaps;
+    QCache<quint64, QPixmap> itsButtonIcons;
     QtCurveConfig          itsConfig;
     QList<QtCurveClient *> itsClients;
+    unsigned long          itsPropertyAtoms[NumClientProperties];
     QtCurveDBus            *itsDBus;
     QColor                 itsHoverCols[2];
+    // Option-less pixel metrics of wStyle(), cleared on every reset
+    mutable QHash<int, int> itsStyleMetrics;
 #if KDE_IS_VERSION(4, 3, 0)
     QtCurveShadowCache     itsShadowCache;
 #endif
@@ -76,6 +76,11 @@ static QColor calcLightColor(const QColor &color)
     return KColorScheme::shade(color, KColorScheme::LightShade, 0.7/*_contrast*/);
 }
 
+static QColor backgroundColor(const QtCurveClient *client)
+{
+    return client->widget()->palette().color(client->widget()->backgroundRole());
+}
+
 QtCurveShadowCache::QtCurveShadowCache()
                   : activeShadowConfiguration_(QtCurveShadowConfiguration(QPalette::Active))
                   , inactiveShadowConfiguration_(QtCurveShadowConfiguration(QPalette::Inactive))
@@ -101,14 +106,15 @@ void QtCurveShadowCache::setShadowConfiguration(const QtCurveShadowConfiguration
 
 TileSet * QtCurveShadowCache::tileSet(const QtCurveClient *client, bool roundAllCorners)
 {
-    Key key(client);
-    int hash(key.hash());
+    Key     key(client, roundAllCorners);
+    quint64 hash(key.hash());
+    TileSet *tileSet = shadowCache_.object(hash);
 
-    if(shadowCache_.contains(hash))
-        return shadowCache_.object(hash);
+    if(tileSet)
+        return tileSet;
 
-    qreal   size(shadowSize());
-    TileSet *tileSet = new TileSet(shadowPixmap(client, key.active, roundAllCorners), size, size, 1, 1);
+    qreal size(shadowSize());
+    tileSet = new TileSet(simpleShadowPixmap(QColor(key.color), key.active, roundAllCorners), size, size, 1, 1);
 
     shadowCache_.insert(hash, tileSet);
     return tileSet;
@@ -116,11 +122,7 @@ TileSet * QtCurveShadowCache::tileSet(const QtCurveClient *client, bool roundAll
 
 QPixmap QtCurveShadowCache::shadowPixmap(const QtCurveClient *client, bool active, bool roundAllCorners) const
 {
-    Key      key(client);
-    QPalette palette(client->widget()->palette());
-    QColor   color(palette.color(client->widget()->backgroundRole()));
-
-    return simpleShadowPixmap(color, active, roundAllCorners);
+    return simpleShadowPixmap(backgroundColor(client), active, roundAllCorners);
 }
 
 QPixmap QtCurveShadowCache::simpleShadowPixmap(const QColor &color, bool active, bool roundAllCorners) const
@@ -397,9 +399,10 @@ void QtCurveShadowCache::renderGradient(QPainter &p, const QRectF &rect, const Q
     }
 }
 
-QtCurveShadowCache::Key::Key(const QtCurveClient *client)
+QtCurveShadowCache::Key::Key(const QtCurveClient *client, bool round)
                        : active(client->isActive())
-                       , isShade(client->isShade())
+                       , roundAllCorners(round)
+                       , color(backgroundColor(client).rgb())
 {
 }
 
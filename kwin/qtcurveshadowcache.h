@@ -91,19 +91,24 @@ class QtCurveShadowCache
     TileSet * tileSet(const QtCurveClient *client, bool roundAllCorners);
 
     //! Key class to be used into QCache
-    /*! class is entirely inline for optimization */
+    /*!
+    the shadow only depends on the configuration, the activity, the corner
+    rounding and the window background colour, so every client that agrees on
+    these shares the same TileSet. Shaded windows use the same tiles as well.
+    */
     class Key
     {
         public:
 
-        explicit Key() : active(false), isShade(false) {}
-        Key(const QtCurveClient *client);
-        Key(int hash) : active((hash>>1)&1), isShade((hash)&1) {}
+        explicit Key() : active(false), roundAllCorners(false), color(0) {}
+        Key(const QtCurveClient *client, bool roundAllCorners);
+        Key(quint64 hash) : active((hash>>1)&1), roundAllCorners((hash)&1), color(hash>>2) {}
 
-        int hash() const { return (active <<1)|(isShade); }
+        quint64 hash() const { return (quint64(color)<<2)|(active<<1)|(roundAllCorners); }
 
         bool active,
-             isShade;
+             roundAllCorners;
+        QRgb color;
     };
 
     static qreal square(qreal x) { return x*x; }
@@ -159,7 +164,7 @@ class QtCurveShadowCache
     /*! a separate method is used in order to properly account for corners */
     void renderGradient(QPainter &p, const QRectF &rect, const QRadialGradient &rg, bool hasBorder) const;
 
-    typedef QCache<int, TileSet> TileSetCache;
+    typedef QCache<quint64, TileSet> TileSetCache;
 
     QtCurveShadowConfiguration activeShadowConfiguration_,
                                inactiveShadowConfiguration_;
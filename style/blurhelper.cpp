@@ -50,7 +50,7 @@ BlurHelper::BlurHelper(QObject *parent):
 {
 #ifdef QTC_X11
     // create atom
-    _atom = XcbUtils::getAtom("_KDE_NET_WM_BLUR_BEHIND_REGION");
+    _atom = XcbUtils::atom(XcbUtils::ATOM_KDE_NET_WM_BLUR_BEHIND_REGION);
 #endif
 }
 
@@ -63,54 +63,67 @@ void BlurHelper::unregisterWidget( QWidget* widget )
 {
     widget->removeEventFilter( this );
     if( isTransparent( widget ) ) clear( widget );
+    forget( widget );
 }
 
 //___________________________________________________________
 bool BlurHelper::eventFilter( QObject* object, QEvent* event )
 {
 
-    // do nothing if not enabled
-    if( !enabled() ) return false;
-
+    // the bookkeeping has to be kept up to date even while disabled,
+    // otherwise destroyed or reparented widgets would stay in the maps
     switch( event->type() )
     {
 
-    case QEvent::Hide:
+    case QEvent::Destroy:
+    {
+        // sent from ~QWidget, only the address can be used
+        forget( static_cast<QWidget*>( object ) );
+        break;
+    }
+
+    case QEvent::ParentChange:
     {
         QWidget* widget( qobject_cast<QWidget*>( object ) );
-        if( widget && isOpaque( widget ) )
+        if( !widget ) break;
+        forget( widget );
+        if( enabled() && !widget->isWindow() && isOpaque( widget ) )
         {
             QWidget* window( widget->window() );
-            if (window && isTransparent(window) && !_pendingWidgets.contains(window) )
-            {
-                _pendingWidgets.insert( window, window );
-                delayedUpdate();
-            }
+            if( isTransparent( window ) ) updateChild( window, widget );
         }
         break;
-
     }
 
     case QEvent::Show:
+    case QEvent::Hide:
     case QEvent::Resize:
+    case QEvent::Move:
     {
 
+        // do nothing if not enabled
+        if( !enabled() ) break;
+
         // cast to widget and check
         QWidget* widget( qobject_cast<QWidget*>( object ) );
         if( !widget ) break;
-        if( isTransparent( widget ) )
+        if( widget->isWindow() )
         {
 
-            _pendingWidgets.insert( widget, widget );
-            delayedUpdate();
+            if( event->type() == QEvent::Hide ) forget( widget );
+            else if( event->type() != QEvent::Move && isTransparent( widget ) ) schedule( widget );
 
-        } else if( isOpaque( widget ) ) {
+        } else {
 
             QWidget* window( widget->window() );
-            if( isTransparent( window ) )
+            if( !isTransparent( window ) ) break;
+
+            if( isOpaque( widget ) ) updateChild( window, widget );
+            else if( event->type() == QEvent::Move )
             {
-                _pendingWidgets.insert( window, window );
-                delayedUpdate();
+                // opaque children are moved along without receiving any event
+                WindowDataMap::const_iterator iter( _windows.constFind( window ) );
+                if( iter != _windows.constEnd() && !iter->opaque.isEmpty() ) invalidate( window );
             }
 
         }
@@ -128,39 +141,121 @@ bool BlurHelper::eventFilter( QObject* object, QEvent* event )
 }
 
 //___________________________________________________________
-QRegion BlurHelper::blurRegion( QWidget* widget ) const
+void BlurHelper::updateChild( QWidget* window, QWidget* child )
+{
+    WindowDataMap::iterator iter( _windows.find( window ) );
+
+    // the whole window is rebuilt anyway
+    if( iter == _windows.end() || !iter->valid )
+    {
+        schedule( window );
+        return;
+    }
+
+    const QRegion region( child->isVisible() ? opaqueRegion( window, child ) : QRegion() );
+    QHash<QWidget*, QRegion>::iterator childIter( iter->opaque.find( child ) );
+    if( region.isEmpty() )
+    {
+
+        if( childIter == iter->opaque.end() ) return;
+        iter->opaque.erase( childIter );
+        _childWindows.remove( child );
+
+    } else {
+
+        if( childIter != iter->opaque.end() && *childIter == region ) return;
+        iter->opaque.insert( child, region );
+        _childWindows.insert( child, window );
+
+    }
+
+    schedule( window );
+}
+
+//___________________________________________________________
+void BlurHelper::invalidate( QWidget* window )
+{
+    WindowDataMap::iterator iter( _windows.find( window ) );
+    if( iter != _windows.end() && iter->valid )
+    {
+        foreach( QWidget* child, iter->opaque.keys() )
+        { _childWindows.remove( child ); }
+
+        iter->opaque.clear();
+        iter->valid = false;
+    }
+
+    schedule( window );
+}
+
+//___________________________________________________________
+void BlurHelper::forget( QWidget* widget )
+{
+    QHash<QWidget*, QWidget*>::iterator childIter( _childWindows.find( widget ) );
+    if( childIter != _childWindows.end() )
+    {
+        WindowDataMap::iterator iter( _windows.find( *childIter ) );
+        if( iter != _windows.end() )
+        {
+            iter->opaque.remove( widget );
+            schedule( *childIter );
+        }
+
+        _childWindows.erase( childIter );
+    }
+
+    WindowDataMap::iterator iter( _windows.find( widget ) );
+    if( iter != _windows.end() )
+    {
+        foreach( QWidget* child, iter->opaque.keys() )
+        { _childWindows.remove( child ); }
+
+        _windows.erase( iter );
+    }
+
+    _pendingWidgets.remove( widget );
+}
+
+//___________________________________________________________
+QRegion BlurHelper::blurRegion( QWidget* widget )
 {
     if( !widget->isVisible() ) return QRegion();
 
     // get main region
     QRegion region = widget->mask().isEmpty() ? widget->rect():widget->mask();
 
+    // remove the opaque children, collecting them if needed
+    WindowData& data( _windows[widget] );
+    if( !data.valid )
+    {
+        collectOpaque( widget, widget, data );
+        data.valid = true;
+    }
+
+    foreach( const QRegion& opaque, data.opaque )
+    { region -= opaque; }
 
-    // trim blur region to remove unnecessary areas
-    trimBlurRegion( widget, widget, region );
     return region;
 
 }
 
 //___________________________________________________________
-void BlurHelper::trimBlurRegion( QWidget* parent, QWidget* widget, QRegion& region ) const
+void BlurHelper::collectOpaque( QWidget* window, QWidget* widget, WindowData& data )
 {
 
-
     // loop over children
     foreach( QObject* childObject, widget->children() )
     {
         QWidget* child( qobject_cast<QWidget*>( childObject ) );
-        if( !(child && child->isVisible()) ) continue;
+        if( !(child && child->isVisible()) || child->isWindow() ) continue;
 
         if( isOpaque( child ) )
         {
 
-            const QPoint offset( child->mapTo( parent, QPoint( 0, 0 ) ) );
-            if( child->mask().isEmpty() ) region -= child->rect().translated( offset );
-            else region -= child->mask().translated( offset );
+            data.opaque.insert( child, opaqueRegion( window, child ) );
+            _childWindows.insert( child, window );
 
-        } else { trimBlurRegion( parent, child, region ); }
+        } else { collectOpaque( window, child, data ); }
 
     }
 
@@ -169,7 +264,7 @@ void BlurHelper::trimBlurRegion( QWidget* parent, QWidget* widget, QRegion& regi
 }
 
 //___________________________________________________________
-void BlurHelper::update( QWidget* widget ) const
+void BlurHelper::update( QWidget* widget )
 {
 #ifdef QTC_X11
     /*
@@ -181,6 +276,14 @@ void BlurHelper::update( QWidget* widget ) const
         return;
 
     const QRegion region( blurRegion( widget ) );
+
+    // only write the property when the region has actually changed
+    WindowData& windowData( _windows[widget] );
+    if (windowData.sent && windowData.region == region)
+        return;
+    windowData.region = region;
+    windowData.sent = true;
+
     if (region.isEmpty()) {
         clear(widget);
     } else {
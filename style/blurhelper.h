@@ -87,17 +87,53 @@ protected:
         }
     }
 
+    //! opaque children of a transparent window
+    struct WindowData {
+        WindowData(): valid(false), sent(false) {}
+        //! region of each opaque child, in window coordinates
+        QHash<QWidget*, QRegion> opaque;
+        //! region last written to the window property
+        QRegion region;
+        //! false if opaque has to be rebuilt from the widget tree
+        bool valid;
+        //! true if region has been written
+        bool sent;
+    };
+
     //! get list of blur-behind regions matching a given widget
-    QRegion blurRegion(QWidget*) const;
+    QRegion blurRegion(QWidget*);
+
+    //! collect the opaque children of a window (recursive)
+    void collectOpaque(QWidget*, QWidget*, WindowData&);
+
+    //! region covered by an opaque child, in window coordinates
+    QRegion opaqueRegion(QWidget *window, QWidget *child) const {
+        const QRegion region(child->mask().isEmpty() ?
+                             QRegion(child->rect()) : child->mask());
+        return region.translated(child->mapTo(window, QPoint(0, 0)));
+    }
+
+    //! update the cached region of a single opaque child
+    void updateChild(QWidget *window, QWidget *child);
 
-    //! trim blur region to remove unnecessary areas (recursive)
-    void trimBlurRegion(QWidget*, QWidget*, QRegion&) const;
+    //! rebuild the cached regions of a window on the next update
+    void invalidate(QWidget *window);
+
+    //! drop all cached data of a window or child
+    void forget(QWidget*);
+
+    //! queue a window for update
+    void schedule(QWidget *window) {
+        _pendingWidgets.insert(window, window);
+        delayedUpdate();
+    }
 
     //! update blur region for all pending widgets
-    /*! a timer is used to allow some buffering of the update requests */
+    /*! a zero timer is used so that all changes of one event loop
+      iteration result in a single update */
     void delayedUpdate() {
         if(!_timer.isActive()) {
-            _timer.start(10, this);
+            _timer.start(0, this);
         }
     }
 
@@ -112,7 +148,8 @@ protected:
     }
 
     //! update blur regions for given widget
-    void update(QWidget*) const;
+    /*! the property is only written if the region has changed */
+    void update(QWidget*);
 
     //! clear blur regions for given widget
     void clear(QWidget*) const;
@@ -139,6 +176,13 @@ private:
     typedef QHash<QWidget*, WidgetPointer> WidgetSet;
     WidgetSet _pendingWidgets;
 
+    //! cached opaque regions of transparent windows
+    typedef QHash<QWidget*, WindowData> WindowDataMap;
+    WindowDataMap _windows;
+
+    //! window each cached opaque child belongs to
+    QHash<QWidget*, QWidget*> _childWindows;
+
     //! delayed update timer
     QBasicTimer _timer;
 
@@ -0,0 +1,110 @@
+/***************************************************************************
+ *   Copyright (C) 2013~2013 by Yichao Yu                                  *
+ *   yyc1992@gmail.com                                                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.              *
+ ***************************************************************************/
+
+#include "gradientramp.h"
+#include <QVarLengthArray>
+#include <string.h>
+
+namespace QtCurve {
+
+void
+setRampStop(QGradientStops &stops, qreal pos, const QColor &col)
+{
+    int index = 0;
+    while (index < stops.size() && stops[index].first < pos)
+        index++;
+    if (index < stops.size() && stops[index].first == pos) {
+        stops[index].second = col;
+    } else {
+        stops.insert(index, QGradientStop(pos, col));
+    }
+}
+
+static inline QRgb
+interpolatePixel(QRgb a, QRgb b, uint f)
+{
+    // f is in [0, 256], a and b are premultiplied. Red/blue and alpha/green
+    // are blended two channels at a time.
+    uint inv = 256 - f;
+    uint rb = ((a & 0xff00ff) * inv + (b & 0xff00ff) * f) >> 8;
+    uint ag = (((a >> 8) & 0xff00ff) * inv + ((b >> 8) & 0xff00ff) * f);
+    return (rb & 0xff00ff) | (ag & 0xff00ff00);
+}
+
+void
+buildGradientRamp(QRgb *ramp, int length, const QGradientStops &stops)
+{
+    if (length <= 0)
+        return;
+    if (stops.isEmpty()) {
+        memset(ramp, 0, length * sizeof(QRgb));
+        return;
+    }
+
+    int numStops = stops.size();
+    QVarLengthArray<QRgb, 16> cols(numStops);
+    for (int i = 0;i < numStops;i++) {
+        cols[i] = qPremultiply(stops[i].second.rgba());
+    }
+
+    double scale = length > 1 ? 1.0 / (length - 1) : 0.0;
+    int stop = 0;
+    for (int i = 0;i < length;i++) {
+        double pos = i * scale;
+        // Positions are increasing, so the current segment only moves
+        // forward.
+        while (stop < numStops && stops[stop].first <= pos)
+            stop++;
+        if (stop == 0) {
+            ramp[i] = cols[0];
+        } else if (stop == numStops) {
+            ramp[i] = cols[numStops - 1];
+        } else {
+            double from = stops[stop - 1].first;
+            double span = stops[stop].first - from;
+            uint f = span > 0 ? (uint)((pos - from) / span * 256 + 0.5) : 256;
+            ramp[i] = interpolatePixel(cols[stop - 1], cols[stop],
+                                       qMin(f, 256u));
+        }
+    }
+}
+
+QImage
+gradientRampImage(const QGradientStops &stops, int length, bool horiz)
+{
+    if (length < 1)
+        return QImage();
+
+    QImage img(horiz ? 1 : length, horiz ? length : 1,
+               QImage::Format_ARGB32_Premultiplied);
+    if (horiz) {
+        // One pixel per scanline.
+        QVarLengthArray<QRgb, 512> ramp(length);
+        buildGradientRamp(ramp.data(), length, stops);
+        for (int y = 0;y < length;y++) {
+            *(QRgb*)img.scanLine(y) = ramp[y];
+        }
+    } else {
+        buildGradientRamp((QRgb*)img.scanLine(0), length, stops);
+    }
+    return img;
+}
+
+}
@@ -0,0 +1,53 @@
+/***************************************************************************
+ *   Copyright (C) 2013~2013 by Yichao Yu                                  *
+ *   yyc1992@gmail.com                                                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.              *
+ ***************************************************************************/
+
+#ifndef __QTC_GRADIENT_RAMP_H__
+#define __QTC_GRADIENT_RAMP_H__
+
+#include <QGradient>
+#include <QImage>
+
+namespace QtCurve {
+
+/*
+  Insert a stop keeping the list sorted, replacing a stop at the same
+  position. Same semantics as QGradient::setColorAt().
+*/
+void setRampStop(QGradientStops &stops, qreal pos, const QColor &col);
+
+/*
+  Sample the stops into a ramp of premultiplied ARGB pixels, interpolating
+  in premultiplied space as QPainter does for QLinearGradient. Pixel centres
+  are mapped onto [0, length - 1] like a gradient from the first to the last
+  pixel of a QRect.
+*/
+void buildGradientRamp(QRgb *ramp, int length, const QGradientStops &stops);
+
+/*
+  Render the stops into a one pixel thick premultiplied image, length pixels
+  high (horiz) or wide. Tiling it across a rect of that height (width) gives
+  the gradient running top to bottom (left to right) without QPainter's per
+  pixel gradient fetch.
+*/
+QImage gradientRampImage(const QGradientStops &stops, int length, bool horiz);
+
+}
+
+#endif
@@ -0,0 +1,235 @@
+/***************************************************************************
+ *   Copyright (C) 2013~2013 by Yichao Yu                                  *
+ *   yyc1992@gmail.com                                                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.              *
+ ***************************************************************************/
+
+#include "pixmapcache.h"
+
+namespace QtCurve {
+
+const char*
+pixmapCacheTypeName(EPixmapCacheType type)
+{
+    switch (type) {
+    case PIXCACHE_BEVEL:
+        return "bevel";
+    case PIXCACHE_GRADIENT:
+        return "gradient";
+    case PIXCACHE_BGND:
+        return "background";
+    case PIXCACHE_RADIAL:
+        return "background-shine";
+    case PIXCACHE_STRIPES:
+        return "stripes";
+    case PIXCACHE_PROGRESS:
+        return "progress";
+    case PIXCACHE_CHECK:
+        return "check";
+    case PIXCACHE_SELECTION:
+        return "selection";
+    case PIXCACHE_RAMP:
+        return "gradient-ramp";
+    default:
+        return "other";
+    }
+}
+
+static inline uint
+hashKey(const PixmapKey &key)
+{
+    // FNV-1a over the five words, followed by a final mix so that the low
+    // bits (used for the bucket index) depend on every field.
+    const quint32 *words = (const quint32*)&key;
+    uint hash = 2166136261u;
+    for (size_t i = 0;i < sizeof(PixmapKey) / sizeof(quint32);i++) {
+        hash = (hash ^ words[i]) * 16777619u;
+    }
+    hash ^= hash >> 15;
+    hash *= 0x2c1b3c6du;
+    hash ^= hash >> 12;
+    return hash;
+}
+
+static inline int
+pixmapCost(const QPixmap &pix)
+{
+    // 24bit pixmaps are stored with 32bit per pixel (both by the X server
+    // and by the raster backend), bitmaps with one bit per pixel.
+    int depth = pix.depth();
+    int bytesPerLine = (depth > 16 ? pix.width() * 4 :
+                        depth > 8 ? pix.width() * 2 :
+                        depth > 1 ? pix.width() : (pix.width() + 7) / 8);
+    return bytesPerLine * pix.height();
+}
+
+PixmapCache::PixmapCache(int maxBytes, int capacity) :
+    itsMask(0),
+    itsCount(0),
+    itsMaxCount(0),
+    itsBytes(0),
+    itsMaxBytes(maxBytes),
+    itsTick(0)
+{
+    memset(itsStats, 0, sizeof(itsStats));
+    int size = 16;
+    while (size < capacity)
+        size <<= 1;
+    itsMask = size - 1;
+    // Keep the load factor below 3/4 so that probe sequences stay short.
+    itsMaxCount = size / 4 * 3;
+}
+
+int
+PixmapCache::lookup(const PixmapKey &key, uint hash) const
+{
+    if (itsEntries.isEmpty())
+        return -1;
+    for (int i = hash & itsMask;;i = (i + 1) & itsMask) {
+        const Entry &entry = itsEntries[i];
+        if (!entry.used)
+            return -1;
+        if (entry.hash == hash && entry.key == key) {
+            return i;
+        }
+    }
+}
+
+bool
+PixmapCache::find(const PixmapKey &key, QPixmap &pix)
+{
+    int index = lookup(key, hashKey(key));
+    if (index < 0) {
+        statsOf(itsStats, key).misses++;
+        return false;
+    }
+    statsOf(itsStats, key).hits++;
+    Entry &entry = itsEntries[index];
+    entry.lastUse = ++itsTick;
+    pix = entry.pix;
+    return true;
+}
+
+void
+PixmapCache::insert(const PixmapKey &key, const QPixmap &pix, qint64 renderNs)
+{
+    int cost = pixmapCost(pix);
+    if (cost > itsMaxBytes)
+        return;
+    if (itsEntries.isEmpty())
+        itsEntries.resize(itsMask + 1);
+
+    uint hash = hashKey(key);
+    int index = lookup(key, hash);
+    if (index >= 0)
+        remove(index);
+    while (itsCount > 0 && (itsCount >= itsMaxCount ||
+                            itsBytes + cost > itsMaxBytes)) {
+        evictOldest();
+    }
+
+    PixmapCacheStats &stats = statsOf(itsStats, key);
+    stats.inserts++;
+    stats.bytes += cost;
+    stats.renderNs += renderNs;
+
+    int i = hash & itsMask;
+    while (itsEntries[i].used)
+        i = (i + 1) & itsMask;
+    Entry &entry = itsEntries[i];
+    entry.used = true;
+    entry.hash = hash;
+    entry.cost = cost;
+    entry.lastUse = ++itsTick;
+    entry.key = key;
+    entry.pix = pix;
+    itsCount++;
+    itsBytes += cost;
+}
+
+void
+PixmapCache::remove(int index)
+{
+    itsBytes -= itsEntries[index].cost;
+    statsOf(itsStats, itsEntries[index].key).bytes -= itsEntries[index].cost;
+    itsCount--;
+    itsEntries[index].used = false;
+    itsEntries[index].pix = QPixmap();
+
+    // Backward shift deletion, move later entries of the same probe
+    // sequence into the hole so that no tombstones are needed.
+    int hole = index;
+    for (int i = (index + 1) & itsMask;itsEntries[i].used;
+         i = (i + 1) & itsMask) {
+        int home = itsEntries[i].hash & itsMask;
+        bool inRange = (hole <= i ? (hole < home && home <= i) :
+                        (hole < home || home <= i));
+        if (inRange)
+            continue;
+        itsEntries[hole] = itsEntries[i];
+        itsEntries[i].used = false;
+        itsEntries[i].pix = QPixmap();
+        hole = i;
+    }
+}
+
+void
+PixmapCache::evictOldest()
+{
+    int oldest = -1;
+    for (int i = 0;i <= itsMask;i++) {
+        const Entry &entry = itsEntries[i];
+        if (entry.used && (oldest < 0 ||
+                           // Wrap-around safe comparison of the use ticks.
+                           (qint32)(entry.lastUse -
+                                    itsEntries[oldest].lastUse) < 0)) {
+            oldest = i;
+        }
+    }
+    if (oldest >= 0) {
+        statsOf(itsStats, itsEntries[oldest].key).evictions++;
+        remove(oldest);
+    }
+}
+
+void
+PixmapCache::trim(int maxBytes)
+{
+    while (itsCount > 0 && itsBytes > maxBytes) {
+        evictOldest();
+    }
+}
+
+void
+PixmapCache::setMaxBytes(int maxBytes)
+{
+    itsMaxBytes = maxBytes;
+    trim(maxBytes);
+}
+
+void
+PixmapCache::clear()
+{
+    itsEntries.clear();
+    itsCount = 0;
+    itsBytes = 0;
+    for (int i = 0;i < PIXCACHE_NUM_TYPES;i++) {
+        itsStats[i].bytes = 0;
+    }
+}
+
+}
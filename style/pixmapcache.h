@@ -0,0 +1,165 @@
+/***************************************************************************
+ *   Copyright (C) 2013~2013 by Yichao Yu                                  *
+ *   yyc1992@gmail.com                                                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.              *
+ ***************************************************************************/
+
+#ifndef __QTC_PIXMAP_CACHE_H__
+#define __QTC_PIXMAP_CACHE_H__
+
+#include <QPixmap>
+#include <QVector>
+#include <string.h>
+
+namespace QtCurve {
+
+enum EPixmapCacheType {
+    PIXCACHE_BEVEL = 1,
+    PIXCACHE_GRADIENT,
+    PIXCACHE_BGND,
+    PIXCACHE_RADIAL,
+    PIXCACHE_STRIPES,
+    PIXCACHE_PROGRESS,
+    PIXCACHE_CHECK,
+    PIXCACHE_SELECTION,
+    PIXCACHE_RAMP,
+
+    PIXCACHE_NUM_TYPES
+};
+
+const char *pixmapCacheTypeName(EPixmapCacheType type);
+
+struct PixmapCacheStats {
+    quint64 hits;
+    quint64 misses;
+    quint64 inserts;
+    quint64 evictions;
+    qint64 bytes;
+    // Time spent rendering the pixmaps that were inserted after a miss.
+    qint64 renderNs;
+};
+
+/*
+  Fixed size key for PixmapCache. The meaning of each field depends on the
+  type, see the pixmapKey() helpers below. Unused fields must be zero.
+*/
+struct PixmapKey {
+    quint32 type;
+    quint32 color;
+    quint32 size;
+    quint32 state;
+    quint32 extra;
+};
+
+static inline bool
+operator==(const PixmapKey &a, const PixmapKey &b)
+{
+    return memcmp(&a, &b, sizeof(PixmapKey)) == 0;
+}
+
+static inline PixmapKey
+pixmapKey(EPixmapCacheType type, quint32 color, quint32 width=0,
+          quint32 height=0, quint32 state=0, quint32 extra=0)
+{
+    PixmapKey key = {type, color, (width << 16) | (height & 0xFFFF),
+                     state, extra};
+    return key;
+}
+
+static inline PixmapKey
+bevelPixmapKey(int widget, bool onToolbar, int round, int realRound,
+               const QSize &size, uint state, QRgb fill, double radius)
+{
+    PixmapKey key = pixmapKey(PIXCACHE_BEVEL, fill, size.width(),
+                              size.height(), state, (int)(radius * 100));
+    key.type |= ((widget & 0xFF) << 8) | ((onToolbar ? 1 : 0) << 16) |
+        ((realRound & 0x7) << 17) | ((round & 0xFF) << 20);
+    return key;
+}
+
+/*
+  Open addressing (linear probing) hash table of pixmaps owned by the style.
+  Unlike QPixmapCache there is no string formatting or hashing and no heap
+  allocation on a lookup. When either the entry or the byte limit is reached
+  the least recently used entry is dropped.
+
+  Lookups, insertions and evictions are counted per EPixmapCacheType (the
+  low byte of PixmapKey::type).
+*/
+class PixmapCache {
+public:
+    explicit PixmapCache(int maxBytes, int capacity=1024);
+
+    bool find(const PixmapKey &key, QPixmap &pix);
+    void insert(const PixmapKey &key, const QPixmap &pix, qint64 renderNs=0);
+    void clear();
+    // Drop least recently used entries until at most maxBytes are resident.
+    void trim(int maxBytes);
+    void setMaxBytes(int maxBytes);
+
+    int maxBytes() const
+    {
+        return itsMaxBytes;
+    }
+    int count() const
+    {
+        return itsCount;
+    }
+    int bytes() const
+    {
+        return itsBytes;
+    }
+    const PixmapCacheStats &stats(EPixmapCacheType type) const
+    {
+        return itsStats[type];
+    }
+
+private:
+    struct Entry {
+        Entry() : used(false), hash(0), cost(0), lastUse(0) {}
+        bool used;
+        uint hash;
+        int cost;
+        quint32 lastUse;
+        PixmapKey key;
+        QPixmap pix;
+    };
+
+    static PixmapCacheStats &statsOf(PixmapCacheStats *stats,
+                                     const PixmapKey &key)
+    {
+        int type = key.type & 0xFF;
+        return stats[type < PIXCACHE_NUM_TYPES ? type : 0];
+    }
+
+    int lookup(const PixmapKey &key, uint hash) const;
+    void remove(int index);
+    void evictOldest();
+
+    QVector<Entry> itsEntries;
+    int itsMask;
+    int itsCount;
+    int itsMaxCount;
+    int itsBytes;
+    int itsMaxBytes;
+    quint32 itsTick;
+    PixmapCacheStats itsStats[PIXCACHE_NUM_TYPES];
+};
+
+}
+
+#endif
@@ -28,6 +28,7 @@
 #include "blurhelper.h"
 #include "shortcuthandler.h"
 #include "pixmaps.h"
+#include "gradientramp.h"
 #include "config_file.h"
 #include "debug.h"
 
@@ -58,6 +59,8 @@
 #include <QSettings>
 #include <QPixmapCache>
 #include <QTextStream>
+#include <QElapsedTimer>
+#include <QtConcurrentRun>
 
 #ifdef QTC_X11
 #include "shadowhelper.h"
@@ -299,20 +302,6 @@ static bool isOnToolbar(const QWidget *widget)
     return false;
 }
 
-/*
-  Cache key:
-  widgettype 2
-  app        5
-  size      15
-  horiz      1
-  alpha      8
-  blue       8
-  green      8
-  red        8
-  type       1  (0 for widget, 1 for pixmap)
-  ------------
-  56
-*/
 enum ECacheType
 {
     CACHE_STD,
@@ -321,7 +310,7 @@ enum ECacheType
     CACHE_TAB_BOT
 };
 
-static QtcKey createKey(qulonglong size, const QColor &color, bool horiz, int app, EWidget w)
+static PixmapKey createKey(int size, const QColor &color, bool horiz, int app, EWidget w)
 {
     ECacheType type=WIDGET_TAB_TOP==w
         ? CACHE_TAB_TOP
@@ -331,19 +320,13 @@ static QtcKey createKey(qulonglong size, const QColor &color, bool horiz, int ap
         ? CACHE_PBAR
         : CACHE_STD;
 
-    return (color.rgba()<<1)+
-        (((qulonglong)(horiz ? 1 : 0))<<33)+
-        (((qulonglong)(size&0xFFFF))<<34)+
-        (((qulonglong)(app&0x1F))<<50)+
-        (((qulonglong)(type&0x03))<<55);
+    return pixmapKey(CACHE_PBAR==type ? PIXCACHE_PROGRESS : PIXCACHE_GRADIENT, color.rgba(), 0, size,
+                     (horiz ? 1 : 0) | (type<<1), app);
 }
 
-static QtcKey createKey(const QColor &color, EPixmap p)
+static PixmapKey createKey(const QColor &color, EPixmap p, double shade)
 {
-    return 1+
-        ((color.rgb()&RGB_MASK)<<1)+
-        (((qulonglong)(p&0x1F))<<33)+
-        (((qulonglong)1)<<38);
+    return pixmapKey(PIXCACHE_CHECK, color.rgb()&RGB_MASK, 0, 0, p, (int)(shade*100));
 }
 
 #if !defined QTC_QT_ONLY
@@ -396,7 +379,9 @@ Style::Style() :
     itsSidebarButtonsCols(0L),
     itsActiveMdiColors(0L),
     itsMdiColors(0L),
-    itsPixmapCache(150000),
+    itsShadeSets(constMaxShadeSets),
+    itsPaths(constMaxPaths),
+    itsPixmapStore(DEFAULT_PIXMAP_CACHE_SIZE * 1024),
     itsActive(true),
     itsSbWidget(0L),
     itsClickedLabel(0L),
@@ -414,6 +399,10 @@ Style::Style() :
     itsBlurHelper(new BlurHelper(this)),
     itsShortcutHandler(new ShortcutHandler(this))
 {
+    for(int i=0; i<2; ++i)
+        connect(&itsBgndImageLoaders[i], &QFutureWatcherBase::finished,
+                this, &Style::bgndImageLoaded);
+
     const char *env = getenv(QTCURVE_PREVIEW_CONFIG);
     if (env && 0 == strcmp(env, QTCURVE_PREVIEW_CONFIG)) {
         // To enable preview of QtCurve settings, the style config module will set QTCURVE_PREVIEW_CONFIG
@@ -463,6 +452,10 @@ void Style::init(bool initial)
 
 #ifdef QTC_X11
         if (initial) {
+            // Lets the cache statistics be queried from a running application.
+            QDBusConnection::sessionBus().registerObject(
+                constDBusStylePath, this,
+                QDBusConnection::ExportScriptableInvokables);
             QDBusConnection::sessionBus().connect(
                 QString(), "/KGlobalSettings", "org.kde.KGlobalSettings",
                 "notifyChange", this, SLOT(kdeGlobalSettingsChange(int, int)));
@@ -490,6 +483,20 @@ void Style::init(bool initial)
 #endif
     }
 
+    // QTCURVE_PIXMAP_CACHE_SIZE (in KiB) overrides pixmapCacheSize for a single application.
+    int  cacheSize(opts.pixmapCacheSize);
+    bool cacheSizeOk(false);
+    int  envCacheSize(qgetenv("QTCURVE_PIXMAP_CACHE_SIZE").toInt(&cacheSizeOk));
+
+    if(cacheSizeOk)
+        cacheSize=envCacheSize;
+    if(cacheSize<MIN_PIXMAP_CACHE_SIZE || cacheSize>MAX_PIXMAP_CACHE_SIZE)
+        cacheSize=DEFAULT_PIXMAP_CACHE_SIZE;
+    itsPixmapStore.setMaxBytes(cacheSize*1024);
+    clearOptionTables();
+    itsPaths.clear();
+    itsEventRoles.clear();
+
     opts.contrast=QSettings(QLatin1String("Trolltech")).value("/Qt/KDE/contrast", DEFAULT_CONTRAST).toInt();
     if(opts.contrast<0 || opts.contrast>10)
         opts.contrast=DEFAULT_CONTRAST;
@@ -741,6 +748,9 @@ void Style::init(bool initial)
         qtcCalcRingAlphas(&itsBackgroundCols[ORIGINAL_SHADE]);
 
     itsBlurHelper->setEnabled(100!=opts.bgndOpacity || 100!=opts.dlgOpacity || 100!=opts.menuBgndOpacity);
+    loadBgndImage(0);
+    loadBgndImage(1);
+    initMetricTables();
 
 #if !defined QTC_QT_ONLY
     // Ensure the link to libkio is not stripped, by placing a call to a kio function.
@@ -756,16 +766,132 @@ void Style::init(bool initial)
 #endif
 }
 
+void Style::loadBgndImage(int index)
+{
+    QtCImage &img=0==index ? opts.bgndImage : opts.menuBgndImage;
+
+    // Forget about any decode started by a previous init()
+    itsBgndImageLoaders[index].setFuture(QFuture<QImage>());
+
+    if(IMG_FILE!=img.type || img.loaded ||
+       !((img.width>16 && img.width<1024 && img.height>16 && img.height<1024) || (0==img.width && 0==img.height)) ||
+       (0==index && opts.noBgndImageApps.contains(appName)) ||
+       // drawBackgroundImage() uses the window's image for menus then
+       (1==index && IMG_FILE==opts.bgndImage.type && opts.bgndImage.pixmap.file==img.pixmap.file))
+        return;
+
+    // Mark as loaded, so that drawBackgroundImage() draws nothing (rather than decoding the image itself) until
+    // bgndImageLoaded() has the result.
+    img.loaded=true;
+    img.pixmap.img=QPixmap();
+    itsBgndImageLoaders[index].setFuture(QtConcurrent::run(qtcDecodeBgndImage, img.pixmap.file, img.width,
+                                                           img.height));
+}
+
+void Style::bgndImageLoaded()
+{
+    QFutureWatcher<QImage> *loader=static_cast<QFutureWatcher<QImage> *>(sender());
+
+    if(loader->isCanceled())
+        return;
+
+    QtCImage &img=loader==&itsBgndImageLoaders[0] ? opts.bgndImage : opts.menuBgndImage;
+
+    img.pixmap.img=QPixmap::fromImage(loader->result());
+    if(!img.pixmap.img.isNull())
+        foreach(QWidget *widget, QApplication::topLevelWidgets())
+            if(widget->isVisible() && widget->style()==this)
+                widget->update();
+}
+
 Style::~Style()
 {
+    if (getenv("QTCURVE_STATS"))
+        dumpCacheStatistics();
+    // The plugin may be unloaded after this, so wait for the decoders.
+    for(int i=0; i<2; ++i)
+        itsBgndImageLoaders[i].waitForFinished();
     freeColors();
 #ifdef QTC_X11
     if (itsDBus) {
         delete itsDBus;
     }
+    if (QDBusConnection::sessionBus().objectRegisteredAt(constDBusStylePath) == this)
+        QDBusConnection::sessionBus().unregisterObject(constDBusStylePath);
 #endif
 }
 
+QVariantMap Style::cacheStatistics() const
+{
+    QVariantMap stats;
+    qulonglong  hits(0),
+                misses(0);
+
+    for(int i=PIXCACHE_BEVEL; i<PIXCACHE_NUM_TYPES; ++i)
+    {
+        EPixmapCacheType       type((EPixmapCacheType)i);
+        const PixmapCacheStats &s(itsPixmapStore.stats(type));
+        QVariantMap            cat;
+
+        cat["hits"]=(qulonglong)s.hits;
+        cat["misses"]=(qulonglong)s.misses;
+        cat["inserts"]=(qulonglong)s.inserts;
+        cat["evictions"]=(qulonglong)s.evictions;
+        cat["bytes"]=(qlonglong)s.bytes;
+        cat["renderNs"]=(qlonglong)s.renderNs;
+        stats[pixmapCacheTypeName(type)]=cat;
+        hits+=s.hits;
+        misses+=s.misses;
+    }
+    stats["hits"]=hits;
+    stats["misses"]=misses;
+    stats["entries"]=itsPixmapStore.count();
+    stats["bytes"]=itsPixmapStore.bytes();
+#ifdef QTC_X11
+    stats["suppressedPropertyWrites"]=(qulonglong)XcbUtils::suppressedPropertyWrites();
+#endif
+    return stats;
+}
+
+void Style::trimPixmapCache()
+{
+    itsPixmapStore.trim(itsPixmapStore.maxBytes()/4);
+}
+
+void Style::applicationStateChanged(Qt::ApplicationState state)
+{
+    // Keep a quarter of the cache so that switching back does not
+    // have to regenerate the most recently used pixmaps.
+    if(Qt::ApplicationActive!=state)
+        trimPixmapCache();
+}
+
+void Style::dumpCacheStatistics() const
+{
+    QTextStream out(stderr);
+
+    out << "QtCurve pixmap cache (" << appName << "): " << itsPixmapStore.count() << " entries, "
+        << itsPixmapStore.bytes() << " bytes\n";
+    for(int i=PIXCACHE_BEVEL; i<PIXCACHE_NUM_TYPES; ++i)
+    {
+        EPixmapCacheType       type((EPixmapCacheType)i);
+        const PixmapCacheStats &s(itsPixmapStore.stats(type));
+
+        out << "  " << pixmapCacheTypeName(type) << ": hits=" << s.hits << " misses=" << s.misses
+            << " inserts=" << s.inserts << " evictions=" << s.evictions << " bytes=" << s.bytes
+            << " render-us=" << s.renderNs/1000 << '\n';
+    }
+#ifdef QTC_X11
+    out << "  suppressed property writes: " << XcbUtils::suppressedPropertyWrites() << '\n';
+#endif
+}
+
+void Style::clearOptionTables() const
+{
+    itsGradientStops.clear();
+    itsShadeSets.clear();
+}
+
 void Style::freeColor(QSet<QColor *> &freedColors, QColor **cols)
 {
     if(!freedColors.contains(*cols) &&
@@ -774,10 +900,7 @@ void Style::freeColor(QSet<QColor *> &freedColors, QColor **cols)
        *cols!=itsMenubarCols &&
        *cols!=itsFocusCols &&
        *cols!=itsMouseOverCols &&
-       *cols!=itsButtonCols &&
-       *cols!=itsColoredButtonCols &&
-       *cols!=itsColoredBackgroundCols &&
-       *cols!=itsColoredHighlightCols)
+       *cols!=itsButtonCols)
     {
         freedColors.insert(*cols);
         delete [] *cols;
@@ -1384,18 +1507,19 @@ void Style::drawLines(QPainter *p, const QRect &r, bool horiz, int nLines, int o
 void Style::drawProgressBevelGradient(QPainter *p, const QRect &origRect, const QStyleOption *option, bool horiz, EAppearance bevApp,
                                       const QColor *cols) const
 {
-    bool    vertical(!horiz),
-        inCache(true);
-    QRect   r(0, 0, horiz ? PROGRESS_CHUNK_WIDTH*2 : origRect.width(),
-              horiz ? origRect.height() : PROGRESS_CHUNK_WIDTH*2);
-    QtcKey  key(createKey(horiz ? r.height() : r.width(), cols[ORIGINAL_SHADE], horiz, bevApp, WIDGET_PROGRESSBAR));
-    QPixmap *pix(itsPixmapCache.object(key));
-
-    if(!pix)
+    bool      vertical(!horiz);
+    QRect     r(0, 0, horiz ? PROGRESS_CHUNK_WIDTH*2 : origRect.width(),
+                horiz ? origRect.height() : PROGRESS_CHUNK_WIDTH*2);
+    PixmapKey key(createKey(horiz ? r.height() : r.width(), cols[ORIGINAL_SHADE], horiz, bevApp, WIDGET_PROGRESSBAR));
+    QPixmap   pix;
+
+    if(!itsPixmapStore.find(key, pix))
     {
-        pix=new QPixmap(r.width(), r.height());
+        QElapsedTimer timer;
+        timer.start();
+        pix=QPixmap(r.width(), r.height());
 
-        QPainter pixPainter(pix);
+        QPainter pixPainter(&pix);
 
         if(IS_FLAT(bevApp))
             pixPainter.fillRect(r, cols[ORIGINAL_SHADE]);
@@ -1451,12 +1575,7 @@ void Style::drawProgressBevelGradient(QPainter *p, const QRect &origRect, const
         }
 
         pixPainter.end();
-        int cost(pix->width()*pix->height()*(pix->depth()/8));
-
-        if(cost<itsPixmapCache.maxCost())
-            itsPixmapCache.insert(key, pix, cost);
-        else
-            inCache=false;
+        itsPixmapStore.insert(key, pix, timer.nsecsElapsed());
     }
     QRect fillRect(origRect);
 
@@ -1477,13 +1596,10 @@ void Style::drawProgressBevelGradient(QPainter *p, const QRect &origRect, const
 
     p->save();
     p->setClipRect(origRect, Qt::IntersectClip);
-    p->drawTiledPixmap(fillRect, *pix);
+    p->drawTiledPixmap(fillRect, pix);
     if(STRIPE_FADE==opts.stripedProgress && fillRect.width()>4 && fillRect.height()>4)
         addStripes(p, QPainterPath(), fillRect, !vertical);
     p->restore();
-
-    if(!inCache)
-        delete pix;
 }
 
 void Style::drawBevelGradient(const QColor &base, QPainter *p, const QRect &origRect, const QPainterPath &path,
@@ -1521,26 +1637,21 @@ void Style::drawBevelGradient(const QColor &base, QPainter *p, const QRect &orig
         {
             QRect   r(0, 0, horiz ? PIXMAP_DIMENSION : origRect.width(),
                       horiz ? origRect.height() : PIXMAP_DIMENSION);
-            QtcKey  key(createKey(horiz ? r.height() : r.width(), base, horiz, app, w));
-            QPixmap *pix(itsPixmapCache.object(key));
-            bool    inCache(true);
+            PixmapKey key(createKey(horiz ? r.height() : r.width(), base, horiz, app, w));
+            QPixmap   pix;
 
-            if(!pix)
+            if(!itsPixmapStore.find(key, pix))
             {
-                pix=new QPixmap(r.width(), r.height());
-                pix->fill(Qt::transparent);
+                QElapsedTimer timer;
+                timer.start();
+                pix=QPixmap(r.width(), r.height());
+                pix.fill(Qt::transparent);
 
-                QPainter pixPainter(pix);
+                QPainter pixPainter(&pix);
 
                 drawBevelGradientReal(base, &pixPainter, r, horiz, sel, app, w);
                 pixPainter.end();
-
-                int cost(pix->width()*pix->height()*(pix->depth()/8));
-
-                if(cost<itsPixmapCache.maxCost())
-                    itsPixmapCache.insert(key, pix, cost);
-                else
-                    inCache=false;
+                itsPixmapStore.insert(key, pix, timer.nsecsElapsed());
             }
 
             if(!path.isEmpty())
@@ -1549,31 +1660,73 @@ void Style::drawBevelGradient(const QColor &base, QPainter *p, const QRect &orig
                 p->setClipPath(path, Qt::IntersectClip);
             }
 
-            p->drawTiledPixmap(origRect, *pix);
+            p->drawTiledPixmap(origRect, pix);
             if(!path.isEmpty())
                 p->restore();
-            if(!inCache)
-                delete pix;
         }
     }
 }
 
-void Style::drawBevelGradientReal(const QColor &base, QPainter *p, const QRect &r, const QPainterPath &path,
-                                  bool horiz, bool sel, EAppearance app, EWidget w) const
+// Bits of the value returned by gradientFlags(), above the appearance.
+enum EGradientFlags
 {
-    bool                             topTab(WIDGET_TAB_TOP==w),
-        botTab(WIDGET_TAB_BOT==w),
-        dwt(CUSTOM_BGND && WIDGET_DOCK_WIDGET_TITLE==w),
-        titleBar(opts.windowBorder&WINDOW_BORDER_BLEND_TITLEBAR &&
-                 (WIDGET_MDI_WINDOW==w || WIDGET_MDI_WINDOW_TITLE==w ||
-                  (opts.dwtSettings&DWT_COLOR_AS_PER_TITLEBAR &&
-                   WIDGET_DOCK_WIDGET_TITLE==w && !dwt))),
+    GRAD_TOP_TAB    = 0x0100,
+    GRAD_BOT_TAB    = 0x0200,
+    GRAD_DWT        = 0x0400,
+    GRAD_TITLEBAR   = 0x0800,
+    GRAD_CLEAR_LAST = 0x1000,
+    GRAD_TOOLTIP    = 0x2000
+};
+
+// The appearance and the properties of the widget that change the compiled
+// stops, so that e.g. all buttons of one colour and appearance share them.
+uint Style::gradientFlags(EAppearance app, EWidget w, bool sel) const
+{
+    bool dwt(CUSTOM_BGND && WIDGET_DOCK_WIDGET_TITLE==w),
         reverse(Qt::RightToLeft==QApplication::layoutDirection());
+    uint flags(app&0xFF);
+
+    if(WIDGET_TAB_TOP==w)
+        flags|=GRAD_TOP_TAB;
+    if(WIDGET_TAB_BOT==w)
+        flags|=GRAD_BOT_TAB;
+    if(dwt)
+        flags|=GRAD_DWT;
+    if(opts.windowBorder&WINDOW_BORDER_BLEND_TITLEBAR &&
+       (WIDGET_MDI_WINDOW==w || WIDGET_MDI_WINDOW_TITLE==w ||
+        (opts.dwtSettings&DWT_COLOR_AS_PER_TITLEBAR && WIDGET_DOCK_WIDGET_TITLE==w && !dwt)))
+        flags|=GRAD_TITLEBAR;
+    if((sel && 0==opts.tabBgnd && !reverse) || dwt)
+        flags|=GRAD_CLEAR_LAST;
+    if(WIDGET_TOOLTIP==w)
+        flags|=GRAD_TOOLTIP;
+    return flags;
+}
+
+const QGradientStops & Style::gradientStops(const QColor &base, EAppearance app, EWidget w, bool sel) const
+{
+    uint    flags(gradientFlags(app, w, sel));
+    bool    topTab(flags&GRAD_TOP_TAB),
+        botTab(flags&GRAD_BOT_TAB),
+        dwt(flags&GRAD_DWT),
+        titleBar(flags&GRAD_TITLEBAR),
+        clearLast(flags&GRAD_CLEAR_LAST),
+        tooltip(flags&GRAD_TOOLTIP);
+    quint64 key((quint64)base.rgba() | ((quint64)flags<<32));
+    QHash<quint64, QGradientStops>::ConstIterator cached(itsGradientStops.constFind(key));
+
+    if(cached!=itsGradientStops.constEnd())
+        return *cached;
+
+    // Colours come and go (e.g. mouse-over blends), keep the table bounded.
+    if(itsGradientStops.size()>=constMaxGradientStops)
+        itsGradientStops.clear();
+
     const Gradient                   *grad=qtcGetGradient(app, &opts);
-    QLinearGradient                  g(r.topLeft(), horiz ? r.bottomLeft() : r.topRight());
     GradientStopCont::const_iterator it(grad->stops.begin()),
         end(grad->stops.end());
     int                              numStops(grad->stops.size());
+    QGradientStops                   stops;
 
     for(int i=0; it!=end; ++it, ++i)
     {
@@ -1590,31 +1743,70 @@ void Style::drawBevelGradientReal(const QColor &base, QPainter *p, const QRect &
             else
             {
                 col=base;
-                if((sel /*&& CUSTOM_BGND*/ && 0==opts.tabBgnd && !reverse) || dwt)
+                if(clearLast)
                     col.setAlphaF(0.0);
             }
         }
         else
             shade(base, &col, botTab && opts.invertBotTab ? qMax(INVERT_SHADE((*it).val), 0.9) : (*it).val);
-        if(WIDGET_TOOLTIP!=w && (*it).alpha<1.0)
+        if(!tooltip && (*it).alpha<1.0)
             col.setAlphaF(col.alphaF()*(*it).alpha);
-        g.setColorAt(botTab ? 1.0-(*it).pos : (*it).pos, col);
+        setRampStop(stops, botTab ? 1.0-(*it).pos : (*it).pos, col);
     }
 
-    if(APPEARANCE_AGUA==app && !(topTab || botTab || dwt) && (horiz ? r.height() : r.width())>AGUA_MAX)
+    return *itsGradientStops.insert(key, stops);
+}
+
+QGradientStops Style::bevelGradientStops(const QColor &base, int length, EAppearance app, EWidget w, bool sel) const
+{
+    QGradientStops stops(gradientStops(base, app, w, sel));
+
+    if(APPEARANCE_AGUA==app && !(WIDGET_TAB_TOP==w || WIDGET_TAB_BOT==w || (CUSTOM_BGND && WIDGET_DOCK_WIDGET_TITLE==w)) &&
+       length>AGUA_MAX)
     {
         QColor col;
-        double pos=AGUA_MAX/((horiz ? r.height() : r.width())*2.0);
+        double pos=AGUA_MAX/(length*2.0);
         shade(base, &col, AGUA_MID_SHADE);
-        g.setColorAt(pos, col);
-        g.setColorAt(1.0-pos, col);
+        setRampStop(stops, pos, col);
+        setRampStop(stops, 1.0-pos, col);
     }
+    return stops;
+}
+
+void Style::drawBevelGradientReal(const QColor &base, QPainter *p, const QRect &r, const QPainterPath &path,
+                                  bool horiz, bool sel, EAppearance app, EWidget w) const
+{
+    int length(horiz ? r.height() : r.width());
 
     //p->fillRect(r, base);
     if(path.isEmpty())
-        p->fillRect(r, QBrush(g));
+    {
+        if(r.width()<1 || r.height()<1)
+            return;
+
+        // The gradient only varies along one axis, so a one pixel thick ramp of
+        // the right length is all that needs to be kept, and tiled over r.
+        QPixmap   ramp;
+        PixmapKey key(pixmapKey(PIXCACHE_RAMP, base.rgba(), horiz ? 1 : length, horiz ? length : 1,
+                                gradientFlags(app, w, sel)));
+
+        if(!itsUsePixmapCache || !itsPixmapStore.find(key, ramp))
+        {
+            QElapsedTimer timer;
+            timer.start();
+            ramp=QPixmap::fromImage(gradientRampImage(bevelGradientStops(base, length, app, w, sel), length, horiz));
+            if(itsUsePixmapCache)
+                itsPixmapStore.insert(key, ramp, timer.nsecsElapsed());
+        }
+        p->drawTiledPixmap(r, ramp);
+    }
     else
+    {
+        QLinearGradient g(r.topLeft(), horiz ? r.bottomLeft() : r.topRight());
+
+        g.setStops(bevelGradientStops(base, length, app, w, sel));
         p->fillPath(path, QBrush(g));
+    }
 }
 
 void Style::drawSunkenBevel(QPainter *p, const QRect &r, const QColor &col) const
@@ -1692,16 +1884,14 @@ void Style::drawLightBevel(QPainter *p, const QRect &r, const QStyleOption *opti
             drawLightBevelReal(p, r, option, widget, round, fill, custom, doBorder, w, true, realRound, onToolbar);
         else
         {
-            QString key;
-            bool    small(circular || (horiz ? r.width() : r.height())<(2*endSize));
-            QPixmap pix;
-            QSize   pixSize(small ? QSize(r.width(), r.height()) : QSize(horiz ? size : r.width(), horiz ? r.height() : size));
-            uint    state(option->state&(State_Raised|State_Sunken|State_On|State_Horizontal|State_HasFocus|State_MouseOver|
-                                         (WIDGET_MDI_WINDOW_BUTTON==w ? State_Active : State_None)));
-
-            key.sprintf("qtc-%x-%x-%x-%x-%x-%x-%x-%x-%x", w, onToolbar ? 1 : 0, round, (int)realRound, pixSize.width(), pixSize.height(),
-                        state, fill.rgba(), (int)(radius*100));
-            if(!itsUsePixmapCache || !QPixmapCache::find(key, pix))
+            bool      small(circular || (horiz ? r.width() : r.height())<(2*endSize));
+            QPixmap   pix;
+            QSize     pixSize(small ? QSize(r.width(), r.height()) : QSize(horiz ? size : r.width(), horiz ? r.height() : size));
+            uint      state(option->state&(State_Raised|State_Sunken|State_On|State_Horizontal|State_HasFocus|State_MouseOver|
+                                           (WIDGET_MDI_WINDOW_BUTTON==w ? State_Active : State_None)));
+            PixmapKey key(bevelPixmapKey(w, onToolbar, round, realRound, pixSize, state, fill.rgba(), radius));
+
+            if(!itsUsePixmapCache || !itsPixmapStore.find(key, pix))
             {
                 pix=QPixmap(pixSize);
                 pix.fill(Qt::transparent);
@@ -1715,7 +1905,7 @@ void Style::drawLightBevel(QPainter *p, const QRect &r, const QStyleOption *opti
                 pixPainter.end();
 
                 if(itsUsePixmapCache)
-                    QPixmapCache::insert(key, pix);
+                    itsPixmapStore.insert(key, pix);
             }
 
             if(small)
@@ -2092,14 +2282,13 @@ void Style::drawBgndRing(QPainter &painter, int x, int y, int size, int size2, b
 QPixmap Style::drawStripes(const QColor &color, int opacity) const
 {
     QPixmap pix;
-    QString key;
     QColor  col(color);
 
     if(100!=opacity)
         col.setAlphaF(opacity/100.0);
 
-    key.sprintf("qtc-stripes-%x", col.rgba());
-    if(!itsUsePixmapCache || !QPixmapCache::find(key, pix))
+    PixmapKey key(pixmapKey(PIXCACHE_STRIPES, col.rgba()));
+    if(!itsUsePixmapCache || !itsPixmapStore.find(key, pix))
     {
         pix=QPixmap(QSize(64, 64));
 
@@ -2133,7 +2322,7 @@ QPixmap Style::drawStripes(const QColor &color, int opacity) const
             pixPainter.drawLine(0, i, pix.width()-1, i);
 
         if(itsUsePixmapCache)
-            QPixmapCache::insert(key, pix);
+            itsPixmapStore.insert(key, pix);
     }
 
     return pix;
@@ -2160,15 +2349,13 @@ void Style::drawBackground(QPainter *p, const QColor &bgnd, const QRect &r, int
             pix=isWindow ? opts.bgndPixmap.img : opts.menuBgndPixmap.img;
         else
         {
-            QString key;
-
             scaledSize=QSize(GT_HORIZ==grad ? constPixmapWidth : r.width(), GT_HORIZ==grad ? r.height() : constPixmapWidth);
 
             if(100!=opacity)
                 col.setAlphaF(opacity/100.0);
 
-            key.sprintf("qtc-bgnd-%x-%d-%d", col.rgba(), grad, app);
-            if(!itsUsePixmapCache || !QPixmapCache::find(key, pix))
+            PixmapKey key(pixmapKey(PIXCACHE_BGND, col.rgba(), 0, 0, grad, app));
+            if(!itsUsePixmapCache || !itsPixmapStore.find(key, pix))
             {
                 pix=QPixmap(QSize(GT_HORIZ==grad ? constPixmapWidth : constPixmapHeight, GT_HORIZ==grad ? constPixmapHeight : constPixmapWidth));
                 pix.fill(Qt::transparent);
@@ -2178,7 +2365,7 @@ void Style::drawBackground(QPainter *p, const QColor &bgnd, const QRect &r, int
                 drawBevelGradientReal(col, &pixPainter, QRect(0, 0, pix.width(), pix.height()), GT_HORIZ==grad, false, app, WIDGET_OTHER);
                 pixPainter.end();
                 if(itsUsePixmapCache)
-                    QPixmapCache::insert(key, pix);
+                    itsPixmapStore.insert(key, pix);
             }
         }
 
@@ -2199,10 +2386,9 @@ void Style::drawBackground(QPainter *p, const QColor &bgnd, const QRect &r, int
         {
             int size=qMin(BGND_SHINE_SIZE, qMin(r.height()*2, r.width()));
 
-            QString key;
-            key.sprintf("qtc-radial-%x", size/BGND_SHINE_STEPS);
+            PixmapKey key(pixmapKey(PIXCACHE_RADIAL, 0, size/BGND_SHINE_STEPS));
 
-            if(!itsUsePixmapCache || !QPixmapCache::find(key, pix))
+            if(!itsUsePixmapCache || !itsPixmapStore.find(key, pix))
             {
                 size/=BGND_SHINE_STEPS;
                 size*=BGND_SHINE_STEPS;
@@ -2224,7 +2410,7 @@ void Style::drawBackground(QPainter *p, const QColor &bgnd, const QRect &r, int
                 pixPainter.fillRect(QRect(0, 0, pix.width(), pix.height()), gradient);
                 pixPainter.end();
                 if(itsUsePixmapCache)
-                    QPixmapCache::insert(key, pix);
+                    itsPixmapStore.insert(key, pix);
             }
 
             p->drawPixmap(r.x()+((r.width()-pix.width())/2), r.y(), pix);
@@ -2395,24 +2581,19 @@ void Style::drawBackground(QPainter *p, const QWidget *widget, BackgroundType ty
     drawBackgroundImage(p, isWindow, imgRect);
 }
 
-QPainterPath Style::buildPath(const QRectF &r, EWidget w, int round, double radius) const
+static QPainterPath createPath(const QRectF &r, bool ellipse, bool open, int round, double radius)
 {
     QPainterPath path;
 
-    if(WIDGET_RADIO_BUTTON==w || WIDGET_DIAL==w ||
-       (WIDGET_MDI_WINDOW_BUTTON==w && opts.titlebarButtons&TITLEBAR_BUTTON_ROUND) ||
-       CIRCULAR_SLIDER(w))
+    if(ellipse)
     {
         path.addEllipse(r);
         return path;
     }
 
-    if(ROUND_NONE==opts.round || (radius<0.01))
-        round=ROUNDED_NONE;
-
     double       diameter(radius*2);
 
-    if (WIDGET_MDI_WINDOW_TITLE!=w && round&CORNER_BR)
+    if (!open && round&CORNER_BR)
         path.moveTo(r.x()+r.width(), r.y()+r.height()-radius);
     else
         path.moveTo(r.x()+r.width(), r.y()+r.height());
@@ -2427,12 +2608,12 @@ QPainterPath Style::buildPath(const QRectF &r, EWidget w, int round, double radi
     else
         path.lineTo(r.x(), r.y());
 
-    if (WIDGET_MDI_WINDOW_TITLE!=w && round&CORNER_BL)
+    if (!open && round&CORNER_BL)
         path.arcTo(r.x(), r.y()+r.height()-diameter, diameter, diameter, 180, 90);
     else
         path.lineTo(r.x(), r.y()+r.height());
 
-    if(WIDGET_MDI_WINDOW_TITLE!=w)
+    if(!open)
     {
         if (round&CORNER_BR)
             path.arcTo(r.x()+r.width()-diameter, r.y()+r.height()-diameter, diameter, diameter, 270, 90);
@@ -2443,6 +2624,49 @@ QPainterPath Style::buildPath(const QRectF &r, EWidget w, int round, double radi
     return path;
 }
 
+// Returns v*scale if that is (close enough to) a whole number less than max, or -1
+static inline int pathKeyPart(double v, int scale, int max)
+{
+    double s(v*scale);
+    int    i(qRound(s));
+
+    return i>=0 && i<max && qAbs(s-i)<0.001 ? i : -1;
+}
+
+QPainterPath Style::buildPath(const QRectF &r, EWidget w, int round, double radius) const
+{
+    bool ellipse(WIDGET_RADIO_BUTTON==w || WIDGET_DIAL==w ||
+                 (WIDGET_MDI_WINDOW_BUTTON==w && opts.titlebarButtons&TITLEBAR_BUTTON_ROUND) ||
+                 CIRCULAR_SLIDER(w)),
+         open(WIDGET_MDI_WINDOW_TITLE==w);
+
+    if(ROUND_NONE==opts.round || (radius<0.01))
+        round=ROUNDED_NONE;
+    round&=ROUNDED_ALL;
+    if(ellipse || ROUNDED_NONE==round)
+        radius=0;
+
+    // The same few shapes are drawn over and over (border, fill, glow and etch of every button, entry, cell,...), so
+    // these are built once at the origin and only translated here. Sizes are in half, radii in 1/100th pixels.
+    int width(pathKeyPart(r.width(), 2, 0x4000)),
+        height(pathKeyPart(r.height(), 2, 0x4000)),
+        rad(pathKeyPart(radius, 100, 0x10000));
+
+    if(width<0 || height<0 || rad<0)
+        return createPath(r, ellipse, open, round, radius);
+
+    quint64      key((quint64)width | ((quint64)height<<14) | ((quint64)rad<<28) | ((quint64)round<<44) |
+                     ((quint64)(ellipse ? 1 : 0)<<48) | ((quint64)(open ? 1 : 0)<<49));
+    QPainterPath *path(itsPaths.object(key));
+
+    if(!path)
+    {
+        path=new QPainterPath(createPath(QRectF(0, 0, r.width(), r.height()), ellipse, open, round, radius));
+        itsPaths.insert(key, path);
+    }
+    return path->translated(r.x(), r.y());
+}
+
 QPainterPath Style::buildPath(const QRect &r, EWidget w, int round, double radius) const
 {
     return buildPath(QRectF(r.x()+0.5, r.y()+0.5, r.width()-1, r.height()-1), w, round, radius);
@@ -3110,7 +3334,7 @@ void Style::drawSbSliderHandle(QPainter *p, const QRect &rOrig, const QStyleOpti
         switch(opts.sliderThumbs)
         {
         case LINE_1DOT:
-            p->drawPixmap(r.x()+((r.width()-5)/2), r.y()+((r.height()-5)/2), *getPixmap(markers[STD_BORDER], PIX_DOT, 1.0));
+            p->drawPixmap(r.x()+((r.width()-5)/2), r.y()+((r.height()-5)/2), getPixmap(markers[STD_BORDER], PIX_DOT, 1.0));
             break;
         case LINE_FLAT:
             drawLines(p, r, !horiz, 3, 5, markers, 0, 5, opts.sliderThumbs);
@@ -3505,7 +3729,7 @@ void Style::drawHandleMarkers(QPainter *p, const QRect &rx, const QStyleOption *
     case LINE_NONE:
         break;
     case LINE_1DOT:
-        p->drawPixmap(r.x()+((r.width()-5)/2), r.y()+((r.height()-5)/2), *getPixmap(border[STD_BORDER], PIX_DOT, 1.0));
+        p->drawPixmap(r.x()+((r.width()-5)/2), r.y()+((r.height()-5)/2), getPixmap(border[STD_BORDER], PIX_DOT, 1.0));
         break;
     case LINE_DOTS:
         drawDots(p, r, !(option->state&State_Horizontal), 2, tb ? 5 : 3, border, tb ? -2 : 0, 5);
@@ -3577,6 +3801,20 @@ void Style::shadeColors(const QColor &base, QColor *vals) const
     vals[ORIGINAL_SHADE]=base;
 }
 
+const QColor * Style::shadeSet(const QColor &base) const
+{
+    quint64  key((quint64)base.rgba() | ((quint64)(opts.shading&0xFF)<<32) | ((quint64)(opts.contrast&0xFF)<<40));
+    ShadeSet *set(itsShadeSets.object(key));
+
+    if(!set)
+    {
+        set=new ShadeSet;
+        shadeColors(base, set->cols);
+        itsShadeSets.insert(key, set);
+    }
+    return set->cols;
+}
+
 const QColor * Style::buttonColors(const QStyleOption *option) const
 {
     if(option && option->version>=TBAR_VERSION_HACK &&
@@ -3586,8 +3824,7 @@ const QColor * Style::buttonColors(const QStyleOption *option) const
 
     if(option && option->palette.button()!=itsButtonCols[ORIGINAL_SHADE])
     {
-        shadeColors(option->palette.button().color(), itsColoredButtonCols);
-        return itsColoredButtonCols;
+        return shadeSet(option->palette.button().color());
     }
 
     return itsButtonCols;
@@ -3633,8 +3870,7 @@ const QColor * Style::backgroundColors(const QColor &col) const
 {
     if(col.alpha()!=0 && col!=itsBackgroundCols[ORIGINAL_SHADE])
     {
-        shadeColors(col, itsColoredBackgroundCols);
-        return itsColoredBackgroundCols;
+        return shadeSet(col);
     }
 
     return itsBackgroundCols;
@@ -3644,8 +3880,7 @@ const QColor * Style::highlightColors(const QColor &col) const
 {
     if(col.alpha()!=0 && col!=itsHighlightCols[ORIGINAL_SHADE])
     {
-        shadeColors(col, itsColoredHighlightCols);
-        return itsColoredHighlightCols;
+        return shadeSet(col);
     }
 
     return itsHighlightCols;
@@ -3954,20 +4189,22 @@ const QColor & Style::getFill(const QStyleOption *option, const QColor *use, boo
         : use[darker ? 2 : ORIGINAL_SHADE];
 }
 
-QPixmap * Style::getPixmap(const QColor col, EPixmap p, double shade) const
+QPixmap Style::getPixmap(const QColor col, EPixmap p, double shade) const
 {
-    QtcKey  key(createKey(col, p));
-    QPixmap *pix=itsPixmapCache.object(key);
+    PixmapKey key(createKey(col, p, shade));
+    QPixmap   pix;
 
-    if(!pix)
+    if(!itsPixmapStore.find(key, pix))
     {
+        QElapsedTimer timer;
+        timer.start();
         if(PIX_DOT==p)
         {
-            pix=new QPixmap(5, 5);
-            pix->fill(Qt::transparent);
+            pix=QPixmap(5, 5);
+            pix.fill(Qt::transparent);
 
             QColor          c(col);
-            QPainter        p(pix);
+            QPainter        p(&pix);
             QLinearGradient g1(0, 0, 5, 5),
                 g2(0, 0, 3, 3);
 
@@ -3989,8 +4226,6 @@ QPixmap * Style::getPixmap(const QColor col, EPixmap p, double shade) const
         }
         else
         {
-            pix=new QPixmap();
-
             QImage img;
 
             switch(p)
@@ -4009,9 +4244,9 @@ QPixmap * Style::getPixmap(const QColor col, EPixmap p, double shade) const
                 img=img.convertToFormat(QImage::Format_ARGB32);
 
             qtcAdjustPix(img.bits(), 4, img.width(), img.height(), img.bytesPerLine(), col.red(), col.green(), col.blue(), shade);
-            *pix=QPixmap::fromImage(img);
+            pix=QPixmap::fromImage(img);
         }
-        itsPixmapCache.insert(key, pix, pix->depth()/8);
+        itsPixmapStore.insert(key, pix, timer.nsecsElapsed());
     }
 
     return pix;
@@ -4226,8 +4461,10 @@ void Style::kdeGlobalSettingsChange(int type, int)
         case KGlobalSettings::StyleChanged:
         {
             KGlobal::config()->reparseConfiguration();
-            if(itsUsePixmapCache)
+            if(itsUsePixmapCache) {
                 QPixmapCache::clear();
+                itsPixmapStore.clear();
+            }
             init(false);
 
             QWidgetList                tlw=QApplication::topLevelWidgets();
@@ -4241,8 +4478,10 @@ void Style::kdeGlobalSettingsChange(int type, int)
         case KGlobalSettings::PaletteChanged:
             KGlobal::config()->reparseConfiguration();
             applyKdeSettings(true);
-            if(itsUsePixmapCache)
+            if(itsUsePixmapCache) {
                 QPixmapCache::clear();
+                itsPixmapStore.clear();
+            }
             break;
         case KGlobalSettings::FontChanged:
             KGlobal::config()->reparseConfiguration();
@@ -4435,7 +4674,7 @@ void Style::emitMenuSize(QWidget *w, unsigned short size, bool force)
         }
 
         if (oldSize != size) {
-            static const auto menuAtom = XcbUtils::getAtom(MENU_SIZE_ATOM);
+            static const auto menuAtom = XcbUtils::atom(XcbUtils::ATOM_QTC_MENU_SIZE);
             w->setProperty(constMenuSizeProperty, size);
             XcbCallVoid(change_property, XCB_PROP_MODE_REPLACE,
                         w->window()->winId(), menuAtom,
@@ -25,16 +25,21 @@
 #include <QTime>
 #include <QPalette>
 #include <QMap>
+#include <QHash>
+#include <QCache>
+#include <QGradient>
 #include <QList>
 #include <QSet>
-#include <QCache>
 #include <QColor>
 #include <QStyleOption>
 #include <QBitmap>
 #include <QFormLayout>
+#include <QVariantMap>
+#include <QFutureWatcher>
+#include <QImage>
 #include <QtGlobal>
-typedef qulonglong QtcKey;
 #include "common.h"
+#include "pixmapcache.h"
 
 #if !defined QTC_QT_ONLY
 #include <KDE/KComponentData>
@@ -68,6 +73,7 @@ class ShadowHelper;
 class Style : public BASE_STYLE {
     Q_OBJECT
     Q_CLASSINFO("X-KDE-CustomElements", "true")
+    Q_CLASSINFO("D-Bus Interface", "org.kde.QtCurve.Style")
 
 public:
     enum BackgroundType {
@@ -171,10 +177,18 @@ public:
         return opts;
     }
 
+    // Per category counters of the pixmap cache, also exported on D-Bus.
+    Q_SCRIPTABLE Q_INVOKABLE QVariantMap cacheStatistics() const;
+    // Drop the least recently used pixmaps, e.g. under memory pressure.
+    Q_SCRIPTABLE Q_INVOKABLE void trimPixmapCache();
+
 private:
     void init(bool initial);
+    void dumpCacheStatistics() const;
     void freeColor(QSet<QColor*> &freedColors, QColor **cols);
     void freeColors();
+    // Drop the tables derived from opts (gradient stops, shade sets).
+    void clearOptionTables() const;
     void polishFormLayout(QFormLayout *layout);
     void polishLayout(QLayout *layout);
     void polishScrollArea(QAbstractScrollArea *scrollArea,
@@ -203,6 +217,12 @@ private:
                            const QPainterPath &path, bool horiz, bool sel,
                            EAppearance bevApp, EWidget w=WIDGET_OTHER,
                            bool useCache=true) const;
+    uint gradientFlags(EAppearance app, EWidget w, bool sel) const;
+    const QGradientStops &gradientStops(const QColor &base, EAppearance app,
+                                        EWidget w, bool sel) const;
+    QGradientStops bevelGradientStops(const QColor &base, int length,
+                                      EAppearance app, EWidget w,
+                                      bool sel) const;
     void drawBevelGradientReal(const QColor &base, QPainter *p,
                                const QRect &r, const QPainterPath &path,
                                bool horiz, bool sel, EAppearance bevApp,
@@ -302,6 +322,7 @@ private:
     void colorTab(QPainter *p, const QRect &r, bool horiz,
                   EWidget tab, int round) const;
     void shadeColors(const QColor &base, QColor *vals) const;
+    const QColor *shadeSet(const QColor &base) const;
     const QColor * buttonColors(const QStyleOption *option) const;
     QColor         titlebarIconColor(const QStyleOption *option) const;
     const QColor * popupMenuCols(const QStyleOption *option=0L) const;
@@ -336,7 +357,7 @@ private:
     const QColor &getTabFill(bool current, bool highlight,
                              const QColor *use) const;
     QColor menuStripeCol() const;
-    QPixmap *getPixmap(const QColor col, EPixmap p, double shade=1.0) const;
+    QPixmap getPixmap(const QColor col, EPixmap p, double shade=1.0) const;
     int konqMenuBarSize(const QMenuBar *menu) const;
     const QColor &checkRadioCol(const QStyleOption *opt) const;
     QColor shade(const QColor &a, double k) const;
@@ -358,9 +379,16 @@ private Q_SLOTS:
     void toggleMenuBar(unsigned int xid);
     void toggleStatusBar(unsigned int xid);
     void compositingToggled();
+    void bgndImageLoaded();
 
 private:
     void widgetDestroyed(QObject *o);
+    void startProgressBarTimer() const;
+    uint eventRoles(QObject *object) const;
+    uint selectionView(const QWidget *widget) const;
+    void initMetricTables();
+    void loadBgndImage(int index);
+    void applicationStateChanged(Qt::ApplicationState state);
     void toggleMenuBar(QMainWindow *window);
     void toggleStatusBar(QMainWindow *window);
 
@@ -402,17 +430,48 @@ private:
     mutable QColor *itsMdiColors;
     mutable QColor itsActiveMdiTextColor;
     mutable QColor itsMdiTextColor;
-    mutable QColor itsColoredButtonCols[TOTAL_SHADES+1];
-    mutable QColor itsColoredBackgroundCols[TOTAL_SHADES+1];
-    mutable QColor itsColoredHighlightCols[TOTAL_SHADES+1];
-    mutable QCache<QtcKey, QPixmap> itsPixmapCache;
+    // Shades of colours other than the palette ones (e.g. widgets with
+    // their own palette), keyed on base colour, shading and contrast.
+    struct ShadeSet {
+        QColor cols[TOTAL_SHADES+1];
+    };
+    mutable QCache<quint64, ShadeSet> itsShadeSets;
+    // Rounded paths, at the origin, see buildPath()
+    mutable QCache<quint64, QPainterPath> itsPaths;
+    mutable PixmapCache itsPixmapStore;
+    mutable QHash<quint64, QGradientStops> itsGradientStops;
     mutable bool itsActive;
     mutable const QWidget *itsSbWidget;
     mutable QLabel *itsClickedLabel;
     QSet<QProgressBar*> itsProgressBars;
+    // Part of each animated bar that changes from frame to frame, as last
+    // painted, so that the timer only needs to invalidate that.
+    struct ProgressBarArea {
+        QRect rect;
+        bool busy;
+        bool vertical;
+    };
+    mutable QHash<const QWidget*, ProgressBarArea> itsProgressBarAreas;
+    // Decode opts.bgndImage (0) and opts.menuBgndImage (1) off the GUI thread.
+    QFutureWatcher<QImage> itsBgndImageLoaders[2];
+    // EEventRole flags of the objects eventFilter() has seen. The roles only
+    // depend on the class, which is stored as well since not every object
+    // that stops being filtered gets its entry removed, and so the address
+    // might be reused by an object of another type.
+    struct EventRoles {
+        const QMetaObject *meta;
+        uint roles;
+    };
+    mutable QHash<const QObject*, EventRoles> itsEventRoles;
+    // ESelectionView of each widget class that drew an item view selection.
+    mutable QHash<const QMetaObject*, uint> itsSelectionViews;
+    // Values of the metrics and hints that depend on neither the option
+    // nor the widget, indexed by PixelMetric / StyleHint.
+    QVector<int> itsPixelMetrics;
+    QVector<int> itsStyleHints;
     QSet<QWidget*> itsTransparentWidgets;
-    int itsProgressBarAnimateTimer,
-        itsAnimateStep;
+    mutable int itsProgressBarAnimateTimer;
+    int itsAnimateStep;
     QTime itsTimer;
     mutable QMap<int, QColor*> itsTitleBarButtonsCols;
 #ifdef QTC_ENABLE_PARENTLESS_DIALOG_FIX_SUPPORT
@@ -64,11 +64,35 @@
 
 namespace QtCurve {
 
+static QRect
+busyChunkRect(const QRect &r, bool vertical, int animateStep)
+{
+    int chunkSize(PROGRESS_CHUNK_WIDTH*3.4),
+        measure(vertical ? r.height() : r.width());
+
+    if(chunkSize>(measure/2))
+        chunkSize=measure/2;
+    if(chunkSize<1)
+        return QRect();
+
+    int step(animateStep % ((measure-chunkSize) * 2));
+
+    if (step > (measure-chunkSize))
+        step = 2 * (measure-chunkSize) - step;
+
+    return vertical ? QRect(r.x(), r.y()+step, r.width(), chunkSize) : QRect(r.x()+step, r.y(), chunkSize, r.height());
+}
+
 void Style::polish(QApplication *app)
 {
     qtcDebug() << __func__;
     // appName = getFile(app->arguments()[0]);
 
+#ifdef QTC_X11
+    // One round trip for all atoms instead of one for each on its first use.
+    XcbUtils::internAtoms();
+#endif
+
     if ("kwin" == appName) {
         theThemedApp = APP_KWIN;
     } else if("systemsettings"==appName)
@@ -163,9 +187,13 @@ void Style::polish(QApplication *app)
     }
 #endif
 
+    // Some of the above are application specific tweaks of opts.
+    initMetricTables();
     BASE_STYLE::polish(app);
     if(opts.hideShortcutUnderline)
         Utils::addEventFilter(app, itsShortcutHandler);
+    connect(app, &QGuiApplication::applicationStateChanged,
+            this, &Style::applicationStateChanged, Qt::UniqueConnection);
 }
 
 void Style::polish(QPalette &palette)
@@ -219,8 +247,10 @@ void Style::polish(QPalette &palette)
            IMG_SQUARE_RINGS==opts.menuBgndImage.type)
         {
             qtcCalcRingAlphas(&itsBackgroundCols[ORIGINAL_SHADE]);
-            if(itsUsePixmapCache)
+            if(itsUsePixmapCache) {
                 QPixmapCache::clear();
+                itsPixmapStore.clear();
+            }
         }
     }
 
@@ -365,10 +395,12 @@ void Style::polish(QWidget *widget)
     }
 
     itsWindowManager->registerWidget(widget);
+    if(opts.hideShortcutUnderline)
+        itsShortcutHandler->registerWidget(widget);
 #ifdef QTC_X11
     itsShadowHelper->registerWidget(widget);
     if (widget->isWindow()) {
-        XcbUtils::setWindowWMClass(widget->winId());
+        XcbUtils::setWindowWMClass(widget);
     }
 #endif
 
@@ -894,6 +926,8 @@ void Style::unpolish(QApplication *app)
     qtcDebug() << __func__;
     if(opts.hideShortcutUnderline)
         app->removeEventFilter(itsShortcutHandler);
+    disconnect(app, &QGuiApplication::applicationStateChanged,
+               this, &Style::applicationStateChanged);
     BASE_STYLE::unpolish(app);
 }
 
@@ -910,11 +944,13 @@ void Style::unpolish(QWidget *widget)
     }
 
     itsWindowManager->unregisterWidget(widget);
+    itsShortcutHandler->unregisterWidget(widget);
 #ifdef QTC_X11
     itsShadowHelper->unregisterWidget(widget);
 #endif
     itsBlurHelper->unregisterWidget(widget);
     unregisterArgbWidget(widget);
+    itsEventRoles.remove(widget);
 
     // Sometimes get background errors with QToolBox (e.g. in Bespin config), and setting WA_StyledBackground seems to
     // fix this,..
@@ -997,6 +1033,7 @@ void Style::unpolish(QWidget *widget)
         if(opts.boldProgress)
             unSetBold(widget);
         itsProgressBars.remove((QProgressBar *)widget);
+        itsProgressBarAreas.remove(widget);
     }
     else if (qobject_cast<QMenuBar*>(widget)) {
         widget->setAttribute(Qt::WA_Hover, false);
@@ -1129,15 +1166,52 @@ void Style::unpolish(QWidget *widget)
 bool Style::eventFilter(QObject *object, QEvent *event)
 {
     qtcDebug() << __func__;
+    uint roles(0);
+
+    // Filter out everything that nothing below is interested in, before doing
+    // any lookups or casts. Some of these can occur really often.
+    switch((int)(event->type()))
+    {
+    case QEvent::MouseMove:
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::MouseButtonDblClick:
+    case QEvent::Wheel:
+        roles=eventRoles(object);
+        if(!(roles&(ROLE_MENUBAR|ROLE_SCROLL_AREA|ROLE_LABEL)) && APP_KONTACT!=theThemedApp)
+            return false;
+        break;
+    case QEvent::Resize:
+    case QEvent::ShortcutOverride:
+    case QEvent::ShowToParent:
+#ifdef QTC_X11
+    case QEvent::PaletteChange:
+#endif
+    case QEvent::Paint:
+    case QEvent::StyleChange:
+    case QEvent::Show:
+    case QEvent::Destroy:
+    case QEvent::Hide:
+    case QEvent::WindowActivate:
+    case QEvent::WindowDeactivate:
+#ifdef QTC_ENABLE_PARENTLESS_DIALOG_FIX_SUPPORT
+    case 70: // QEvent::ChildInserted - QT3_SUPPORT
+#endif
+        roles=eventRoles(object);
+        break;
+    default:
+        return false;
+    }
+
     bool isSViewCont=APP_KONTACT==theThemedApp && itsSViewContainers.contains((QWidget*)object);
 
-    if(::qobject_cast<QMenuBar *>(object) && dynamic_cast<QMouseEvent *>(event))
+    if(roles&ROLE_MENUBAR && dynamic_cast<QMouseEvent *>(event))
     {
         if(updateMenuBarEvent((QMouseEvent *)event, (QMenuBar*)object))
             return true;
     }
 
-    if (QEvent::Show==event->type() && qobject_cast<QAbstractScrollArea *>(object) && object->inherits("KFilePlacesView"))
+    if (QEvent::Show==event->type() && roles&ROLE_PLACES_VIEW)
     {
         QWidget  *view   = ((QAbstractScrollArea *)object)->viewport();
         QPalette palette = view->palette();
@@ -1151,7 +1225,7 @@ bool Style::eventFilter(QObject *object, QEvent *event)
         object->removeEventFilter(this);
     }
 
-    if((!opts.gtkScrollViews &&  ::qobject_cast<QAbstractScrollArea *>(object)) || isSViewCont)
+    if(roles&ROLE_SCROLL_AREA || isSViewCont)
     {
         QPoint pos;
         switch(event->type())
@@ -1232,11 +1306,8 @@ bool Style::eventFilter(QObject *object, QEvent *event)
 
     switch((int)(event->type()))
     {
-    case QEvent::Timer:
-    case QEvent::Move:
-        return false; // just for performance - they can occur really often
     case QEvent::Resize:
-        if(!(opts.square&SQUARE_POPUP_MENUS) && object->inherits("QComboBoxPrivateContainer"))
+        if(!(opts.square&SQUARE_POPUP_MENUS) && roles&ROLE_COMBO_POPUP)
         {
             QWidget *widget=static_cast<QWidget *>(object);
             if(Utils::hasAlphaChannel(widget))
@@ -1250,7 +1321,7 @@ bool Style::eventFilter(QObject *object, QEvent *event)
                  opts.windowBorder &
                  WINDOW_BORDER_USE_MENUBAR_COLOR_FOR_TITLEBAR ||
                  opts.menubarHiding & HIDE_KWIN) &&
-                qobject_cast<QMenuBar*>(object)) {
+                roles&ROLE_MENUBAR) {
             QResizeEvent *re = static_cast<QResizeEvent*>(event);
 
             if (re->size().height() != re->oldSize().height()) {
@@ -1263,7 +1334,7 @@ bool Style::eventFilter(QObject *object, QEvent *event)
 #endif
         break;
     case QEvent::ShortcutOverride:
-        if((opts.menubarHiding || opts.statusbarHiding) && qobject_cast<QMainWindow *>(object))
+        if((opts.menubarHiding || opts.statusbarHiding) && roles&ROLE_MAIN_WINDOW)
         {
             QMainWindow *window=static_cast<QMainWindow *>(object);
 
@@ -1287,10 +1358,10 @@ bool Style::eventFilter(QObject *object, QEvent *event)
         }
         break;
     case QEvent::ShowToParent:
-        if(opts.menubarHiding && itsSaveMenuBarStatus && qobject_cast<QMenuBar *>(object) &&
+        if(opts.menubarHiding && itsSaveMenuBarStatus && roles&ROLE_MENUBAR &&
            qtcMenuBarHidden(appName))
             static_cast<QMenuBar *>(object)->setHidden(true);
-        if(opts.statusbarHiding && itsSaveStatusBarStatus && qobject_cast<QStatusBar *>(object) &&
+        if(opts.statusbarHiding && itsSaveStatusBarStatus && roles&ROLE_STATUSBAR &&
            qtcStatusBarHidden(appName))
             static_cast<QStatusBar *>(object)->setHidden(true);
         break;
@@ -1331,7 +1402,7 @@ bool Style::eventFilter(QObject *object, QEvent *event)
         //bool isCombo=false;
         if((!IS_FLAT_BGND(opts.menuBgndAppearance) || IMG_NONE!=opts.menuBgndImage.type || 100!=opts.menuBgndOpacity ||
             !(opts.square&SQUARE_POPUP_MENUS)) &&
-           (qobject_cast<QMenu*>(object) || (/*isCombo=*/object->inherits("QComboBoxPrivateContainer"))))
+           roles&(ROLE_MENU|ROLE_COMBO_POPUP))
         {
             QWidget      *widget=qobject_cast<QWidget *>(object);
             QPainter     p(widget);
@@ -1408,7 +1479,7 @@ bool Style::eventFilter(QObject *object, QEvent *event)
                 }
             }
         }
-        else if(itsClickedLabel==object && qobject_cast<QLabel*>(object) && ((QLabel *)object)->buddy() && ((QLabel *)object)->buddy()->isEnabled())
+        else if(itsClickedLabel==object && roles&ROLE_LABEL && ((QLabel *)object)->buddy() && ((QLabel *)object)->buddy()->isEnabled())
         {
             // paint focus rect
             QLabel                *lbl = (QLabel *)object;
@@ -1421,7 +1492,7 @@ bool Style::eventFilter(QObject *object, QEvent *event)
         }
         else
         {
-            QFrame *frame = qobject_cast<QFrame*>(object);
+            QFrame *frame = roles&ROLE_FRAME ? static_cast<QFrame*>(object) : 0L;
 
             if (frame)
             {
@@ -1443,7 +1514,7 @@ bool Style::eventFilter(QObject *object, QEvent *event)
         break;
     }
     case QEvent::MouseButtonPress:
-        if(dynamic_cast<QMouseEvent*>(event) && qobject_cast<QLabel*>(object) && ((QLabel *)object)->buddy())
+        if(roles&ROLE_LABEL && ((QLabel *)object)->buddy())
         {
             QLabel      *lbl = (QLabel *)object;
             QMouseEvent *mev = (QMouseEvent *)event;
@@ -1456,7 +1527,7 @@ bool Style::eventFilter(QObject *object, QEvent *event)
         }
         break;
     case QEvent::MouseButtonRelease:
-        if(dynamic_cast<QMouseEvent*>(event) && qobject_cast<QLabel*>(object) && ((QLabel *)object)->buddy())
+        if(roles&ROLE_LABEL && ((QLabel *)object)->buddy())
         {
             QLabel      *lbl = (QLabel *)object;
             QMouseEvent *mev = (QMouseEvent *)event;
@@ -1475,18 +1546,16 @@ bool Style::eventFilter(QObject *object, QEvent *event)
     case QEvent::StyleChange:
     case QEvent::Show:
     {
-        QProgressBar *bar = qobject_cast<QProgressBar *>(object);
+        QProgressBar *bar = roles&ROLE_PROGRESSBAR ? static_cast<QProgressBar *>(object) : 0L;
 
         if(bar)
         {
             itsProgressBars.insert(bar);
             if (1==itsProgressBars.size())
-            {
                 itsTimer.start();
-                itsProgressBarAnimateTimer = startTimer(1000 / constProgressBarFps);
-            }
+            startProgressBarTimer();
         }
-        else if(!(opts.square&SQUARE_POPUP_MENUS) && object->inherits("QComboBoxPrivateContainer"))
+        else if(!(opts.square&SQUARE_POPUP_MENUS) && roles&ROLE_COMBO_POPUP)
         {
             QWidget *widget=static_cast<QWidget *>(object);
             if(Utils::hasAlphaChannel(widget))
@@ -1500,7 +1569,7 @@ bool Style::eventFilter(QObject *object, QEvent *event)
                   opts.windowBorder &
                   WINDOW_BORDER_USE_MENUBAR_COLOR_FOR_TITLEBAR ||
                   opts.menubarHiding & HIDE_KWIN) &&
-                 qobject_cast<QMenuBar*>(object)) {
+                 roles&ROLE_MENUBAR) {
             QMenuBar *mb=(QMenuBar*)object;
             emitMenuSize((QMenuBar*)mb, PREVIEW_MDI==itsIsPreview ||
                          !((QMenuBar *)mb)->isVisible() ? 0 :
@@ -1529,7 +1598,7 @@ bool Style::eventFilter(QObject *object, QEvent *event)
              opts.windowBorder &
              WINDOW_BORDER_USE_MENUBAR_COLOR_FOR_TITLEBAR ||
              opts.menubarHiding & HIDE_KWIN) &&
-           qobject_cast<QMenuBar *>(object)) {
+           roles&ROLE_MENUBAR) {
             QMenuBar *mb = (QMenuBar*)object;
             emitMenuSize((QMenuBar*)mb, 0);
         }
@@ -1544,7 +1613,8 @@ bool Style::eventFilter(QObject *object, QEvent *event)
         // So we have to check on object.
         if (object && !itsProgressBars.isEmpty()) {
             itsProgressBars.remove(reinterpret_cast<QProgressBar*>(object));
-            if (itsProgressBars.isEmpty()) {
+            itsProgressBarAreas.remove(reinterpret_cast<QWidget*>(object));
+            if (itsProgressBars.isEmpty() && itsProgressBarAnimateTimer) {
                 killTimer(itsProgressBarAnimateTimer);
                 itsProgressBarAnimateTimer = 0;
             }
@@ -1564,6 +1634,8 @@ bool Style::eventFilter(QObject *object, QEvent *event)
             itsReparentedDialogs.remove(widget);
         }
 #endif
+        if(QEvent::Destroy==event->type())
+            itsEventRoles.remove(object);
         break;
     }
     case QEvent::Enter:
@@ -1583,7 +1655,7 @@ bool Style::eventFilter(QObject *object, QEvent *event)
     case QEvent::FocusOut:
         break;
     case QEvent::WindowActivate:
-        if(opts.shadeMenubarOnlyWhenActive && SHADE_NONE!=opts.shadeMenubars && qobject_cast<QMenuBar *>(object))
+        if(opts.shadeMenubarOnlyWhenActive && SHADE_NONE!=opts.shadeMenubars && roles&ROLE_MENUBAR)
         {
             itsActive=true;
             ((QWidget *)object)->repaint();
@@ -1591,7 +1663,7 @@ bool Style::eventFilter(QObject *object, QEvent *event)
         }
         break;
     case QEvent::WindowDeactivate:
-        if(opts.shadeMenubarOnlyWhenActive && SHADE_NONE!=opts.shadeMenubars && qobject_cast<QMenuBar *>(object))
+        if(opts.shadeMenubarOnlyWhenActive && SHADE_NONE!=opts.shadeMenubars && roles&ROLE_MENUBAR)
         {
             itsActive=false;
             ((QWidget *)object)->repaint();
@@ -1628,23 +1700,182 @@ bool Style::eventFilter(QObject *object, QEvent *event)
     return BASE_STYLE::eventFilter(object, event);
 }
 
+uint Style::eventRoles(QObject *object) const
+{
+    const QMetaObject *meta=object->metaObject();
+    QHash<const QObject*, EventRoles>::ConstIterator it(itsEventRoles.constFind(object));
+
+    if(it!=itsEventRoles.constEnd() && it->meta==meta)
+        return it->roles;
+
+    uint roles(0);
+
+    if(qobject_cast<QMenuBar *>(object))
+        roles|=ROLE_MENUBAR;
+    else if(qobject_cast<QMenu *>(object))
+        roles|=ROLE_MENU;
+    else if(qobject_cast<QMainWindow *>(object))
+        roles|=ROLE_MAIN_WINDOW;
+    else if(qobject_cast<QStatusBar *>(object))
+        roles|=ROLE_STATUSBAR;
+    else if(qobject_cast<QProgressBar *>(object))
+        roles|=ROLE_PROGRESSBAR;
+    else if(object->inherits("QComboBoxPrivateContainer"))
+        roles|=ROLE_COMBO_POPUP;
+    if(qobject_cast<QLabel *>(object))
+        roles|=ROLE_LABEL;
+    if(qobject_cast<QFrame *>(object))
+        roles|=ROLE_FRAME;
+    if(qobject_cast<QAbstractScrollArea *>(object))
+    {
+        if(!opts.gtkScrollViews)
+            roles|=ROLE_SCROLL_AREA;
+        if(object->inherits("KFilePlacesView"))
+            roles|=ROLE_PLACES_VIEW;
+    }
+    EventRoles entry={meta, roles};
+    itsEventRoles.insert(object, entry);
+    return roles;
+}
+
+uint Style::selectionView(const QWidget *widget) const
+{
+    // Only depends on the class, so there is no need to track the widgets.
+    const QMetaObject                             *meta(widget->metaObject());
+    QHash<const QMetaObject*, uint>::ConstIterator it(itsSelectionViews.constFind(meta));
+
+    if(it!=itsSelectionViews.constEnd())
+        return *it;
+
+    uint view(SEL_VIEW_OTHER);
+
+    if(!widget->inherits("KFilePlacesView"))
+    {
+        if(qobject_cast<const QTreeView *>(widget))
+            view=SEL_VIEW_TREE;
+        else if(qobject_cast<const QListView *>(widget))
+            view=SEL_VIEW_LIST;
+    }
+    itsSelectionViews.insert(meta, view);
+    return view;
+}
+
+void Style::startProgressBarTimer() const
+{
+    if (0==itsProgressBarAnimateTimer && !itsProgressBars.isEmpty())
+        itsProgressBarAnimateTimer = const_cast<Style*>(this)->startTimer(1000 / constProgressBarFps);
+}
+
 void Style::timerEvent(QTimerEvent *event)
 {
     qtcDebug() << __func__;
     if (event->timerId() == itsProgressBarAnimateTimer)
     {
+        // The step is derived from the elapsed time, so late or dropped
+        // ticks do not slow the animation down.
+        int  lastStep(itsAnimateStep);
+        bool animating(false);
+
         itsAnimateStep = itsTimer.elapsed() / (1000 / constProgressBarFps);
         foreach (QProgressBar *bar, itsProgressBars)
-            if ((opts.animatedProgress && 0==itsAnimateStep%2 && bar->value()!=bar->minimum() && bar->value()!=bar->maximum()) ||
-                (0==bar->minimum() && 0==bar->maximum()))
+        {
+            bool busy(0==bar->minimum() && 0==bar->maximum());
+
+            if (!busy && !(opts.animatedProgress && bar->value()!=bar->minimum() && bar->value()!=bar->maximum()))
+                continue;
+            // Bars that can not be seen are skipped, once they are painted
+            // again drawControl() restarts the timer.
+            if (!bar->isVisible() || bar->window()->isMinimized() || bar->visibleRegion().isEmpty())
+                continue;
+            animating=true;
+
+            QHash<const QWidget*, ProgressBarArea>::ConstIterator area(itsProgressBarAreas.constFind(bar));
+
+            if (area==itsProgressBarAreas.constEnd())
                 bar->update();
+            else if (busy)
+            {
+                if (lastStep!=itsAnimateStep)
+                    bar->update(busyChunkRect((*area).rect, (*area).vertical, lastStep) |
+                                busyChunkRect((*area).rect, (*area).vertical, itsAnimateStep));
+            }
+            else if (lastStep/2!=itsAnimateStep/2) // The stripes move every other step
+                bar->update((*area).rect);
+        }
+
+        if (!animating)
+        {
+            killTimer(itsProgressBarAnimateTimer);
+            itsProgressBarAnimateTimer = 0;
+        }
     }
 
     event->ignore();
 }
 
+void Style::initMetricTables()
+{
+    // Only ever add metrics and hints here whose value depends on opts alone.
+    static const PixelMetric constMetrics[] = {
+        PM_MdiSubWindowFrameWidth, PM_DockWidgetTitleMargin, PM_DockWidgetTitleBarButtonMargin,
+        PM_DockWidgetFrameWidth, PM_ToolBarExtensionExtent,
+#ifdef QTC_QT_ONLY
+        PM_SmallIconSize, PM_ToolBarIconSize, PM_IconViewIconSize, PM_LargeIconSize,
+#endif
+        PM_SubMenuOverlap, PM_ScrollView_ScrollBarSpacing, PM_SizeGripSize, PM_TabBarScrollButtonWidth,
+        PM_HeaderMargin, PM_DefaultTopLevelMargin, PM_LayoutHorizontalSpacing, PM_LayoutVerticalSpacing,
+        PM_DefaultLayoutSpacing, PM_MenuBarItemSpacing, PM_ToolBarItemMargin, PM_ToolBarItemSpacing,
+        PM_ToolBarFrameWidth, PM_FocusFrameVMargin, PM_FocusFrameHMargin, PM_MenuHMargin, PM_MenuVMargin,
+        PM_ButtonMargin, PM_TabBarTabShiftVertical, PM_TabBarTabShiftHorizontal, PM_ButtonDefaultIndicator,
+        PM_SpinBoxFrameWidth, PM_IndicatorWidth, PM_IndicatorHeight, PM_ExclusiveIndicatorWidth,
+        PM_ExclusiveIndicatorHeight, PM_TabBarTabOverlap, PM_ProgressBarChunkWidth,
+        PM_DockWidgetSeparatorExtent, PM_SplitterWidth, PM_ToolBarHandleExtent, PM_ScrollBarSliderMin,
+        PM_SliderThickness, PM_SliderControlThickness, PM_SliderTickmarkOffset, PM_SliderLength,
+        PM_ScrollBarExtent, PM_MaximumDragDistance, PM_TabBarTabHSpace, PM_TabBarTabVSpace,
+        PM_MenuBarPanelWidth
+    };
+    static const StyleHint constHints[] = {
+        SH_ComboBox_ListMouseTracking, SH_PrintDialog_RightAlignButtons,
+        SH_ItemView_ArrowKeysNavigateIntoChildren, SH_ToolBox_SelectedPageTitleBold,
+        SH_ScrollBar_MiddleClickAbsolutePosition, SH_SpinControls_DisableOnBounds, SH_Slider_SnapToValue,
+        SH_FontDialog_SelectAssociatedText, SH_Menu_MouseTracking, SH_MessageBox_CenterButtons,
+        SH_ProgressDialog_CenterCancelButton, SH_DitherDisabledText, SH_EtchDisabledText,
+        SH_Menu_AllowActiveAndDisabled, SH_ItemView_ShowDecorationSelected, SH_MenuBar_AltKeyNavigation,
+        SH_ItemView_ChangeHighlightOnFocus, SH_WizardStyle, SH_Menu_SubMenuPopupDelay,
+        SH_ToolButton_PopupDelay, SH_ComboBox_PopupFrameStyle, SH_TabBar_Alignment,
+        SH_Header_ArrowAlignment, SH_TitleBar_NoBorder, SH_TitleBar_AutoRaise,
+        SH_MainWindow_SpaceBelowMenuBar, SH_DialogButtonLayout, SH_MessageBox_TextInteractionFlags,
+        SH_MenuBar_MouseTracking, SH_FormLayoutFormAlignment, SH_FormLayoutLabelAlignment,
+        SH_FormLayoutFieldGrowthPolicy, SH_FormLayoutWrapPolicy
+    };
+    int maxMetric(0),
+        maxHint(0);
+
+    for(const PixelMetric metric: constMetrics)
+        maxMetric=qMax(maxMetric, (int)metric);
+    for(const StyleHint hint: constHints)
+        maxHint=qMax(maxHint, (int)hint);
+
+    // Empty while filling, so that the values come from the code below.
+    itsPixelMetrics.clear();
+    itsStyleHints.clear();
+
+    QVector<int> metrics(maxMetric+1, constNotInTable),
+                 hints(maxHint+1, constNotInTable);
+
+    for(const PixelMetric metric: constMetrics)
+        metrics[metric]=pixelMetric(metric, 0L, 0L);
+    for(const StyleHint hint: constHints)
+        hints[hint]=styleHint(hint, 0L, 0L, 0L);
+    itsPixelMetrics=metrics;
+    itsStyleHints=hints;
+}
+
 int Style::pixelMetric(PixelMetric metric, const QStyleOption *option, const QWidget *widget) const
 {
+    if(metric>=0 && metric<itsPixelMetrics.size() && constNotInTable!=itsPixelMetrics.at(metric))
+        return itsPixelMetrics.at(metric);
+
     qtcDebug() << __func__;
     switch((int)metric)
     {
@@ -1918,6 +2149,9 @@ int Style::pixelMetric(PixelMetric metric, const QStyleOption *option, const QWi
 
 int Style::styleHint(StyleHint hint, const QStyleOption *option, const QWidget *widget, QStyleHintReturn *returnData) const
 {
+    if(hint>=0 && hint<itsStyleHints.size() && constNotInTable!=itsStyleHints.at(hint))
+        return itsStyleHints.at(hint);
+
     qtcDebug() << __func__;
     switch (hint)
     {
@@ -2959,9 +3193,9 @@ void Style::drawPrimitive(PrimitiveElement element, const QStyleOption *option,
 
         if(state&State_On || selectedOOMenu)
         {
-            QPixmap *pix(getPixmap(checkRadioCol(option), PIX_CHECK, 1.0));
+            QPixmap pix(getPixmap(checkRadioCol(option), PIX_CHECK, 1.0));
 
-            painter->drawPixmap(rect.center().x()-(pix->width()/2), rect.center().y()-(pix->height()/2), *pix);
+            painter->drawPixmap(rect.center().x()-(pix.width()/2), rect.center().y()-(pix.height()/2), pix);
         }
         else if (state&State_NoChange)    // tri-state
         {
@@ -3590,12 +3824,9 @@ void Style::drawPrimitive(PrimitiveElement element, const QStyleOption *option,
             QColor color(hasCustomBackground && hasSolidBackground
                          ? v4Opt->backgroundBrush.color()
                          : palette.color(cg, QPalette::Highlight));
-            bool   square((opts.square&SQUARE_LISTVIEW_SELECTION) &&
-                          (/*(!widget && r.height()<=40 && r.width()>=48) || */
-                              (widget && !widget->inherits("KFilePlacesView") &&
-                               (qobject_cast<const QTreeView *>(widget) ||
-                                (qobject_cast<const QListView *>(widget) &&
-                                 QListView::IconMode!=((const QListView *)widget)->viewMode()))))),
+            uint   view(opts.square&SQUARE_LISTVIEW_SELECTION && widget ? selectionView(widget) : SEL_VIEW_OTHER);
+            bool   square(SEL_VIEW_TREE==view ||
+                          (SEL_VIEW_LIST==view && QListView::IconMode!=((const QListView *)widget)->viewMode())),
                 modAlpha(!(state&State_Active) && itsInactiveChangeSelectionColor);
 
             if (hover && !hasCustomBackground)
@@ -3616,18 +3847,23 @@ void Style::drawPrimitive(PrimitiveElement element, const QStyleOption *option,
                 drawBevelGradient(color, painter, r, true, false, opts.selectionAppearance, WIDGET_SELECTION);
             else
             {
-                QPixmap pix;
-                QString key;
+                // The caps are drawn from the 24 pixel wide pixmap, the part
+                // in between is tiled from the middle 8 pixels, which are kept
+                // as a pixmap of their own (state 1).
+                double    radius(qtcGetRadius(&opts, r.width(), r.height(), WIDGET_OTHER, RADIUS_SELECTION));
+                PixmapKey key(pixmapKey(PIXCACHE_SELECTION, color.rgba(), 24, r.height(), 0, (int)(radius*100))),
+                          midKey(key);
+                QPixmap   pix,
+                          mid;
 
-                key.sprintf("qtc-sel-%x-%x", r.height(), color.rgba());
-                if(!itsUsePixmapCache || !QPixmapCache::find(key, pix))
+                midKey.state=1;
+                if(!itsUsePixmapCache || !itsPixmapStore.find(key, pix) || !itsPixmapStore.find(midKey, mid))
                 {
                     pix=QPixmap(QSize(24, r.height()));
                     pix.fill(Qt::transparent);
 
                     QPainter pixPainter(&pix);
                     QRect    border(0, 0, pix.width(), pix.height());
-                    double   radius(qtcGetRadius(&opts, r.width(), r.height(), WIDGET_OTHER, RADIUS_SELECTION));
 
                     pixPainter.setRenderHint(QPainter::Antialiasing, true);
                     drawBevelGradient(color, &pixPainter, border, buildPath(QRectF(border), WIDGET_OTHER, ROUNDED_ALL, radius), true,
@@ -3639,8 +3875,12 @@ void Style::drawPrimitive(PrimitiveElement element, const QStyleOption *option,
                         pixPainter.drawPath(buildPath(border, WIDGET_SELECTION, ROUNDED_ALL, radius));
                     }
                     pixPainter.end();
+                    mid=pix.copy(7, 0, 8, r.height());
                     if(itsUsePixmapCache)
-                        QPixmapCache::insert(key, pix);
+                    {
+                        itsPixmapStore.insert(key, pix);
+                        itsPixmapStore.insert(midKey, mid);
+                    }
                 }
 
                 bool roundedLeft  = false,
@@ -3662,16 +3902,16 @@ void Style::drawPrimitive(PrimitiveElement element, const QStyleOption *option,
 
                 if (!reverse ? roundedLeft : roundedRight)
                 {
-                    painter->drawPixmap(r.topLeft(), pix.copy(0, 0, size, r.height()));
+                    painter->drawPixmap(r.left(), r.top(), pix, 0, 0, size, r.height());
                     r.adjust(size, 0, 0, 0);
                 }
                 if (!reverse ? roundedRight : roundedLeft)
                 {
-                    painter->drawPixmap(r.right() - size + 1, r.top(), pix.copy(24-size, 0, size, r.height()));
+                    painter->drawPixmap(r.right() - size + 1, r.top(), pix, 24-size, 0, size, r.height());
                     r.adjust(0, 0, -size, 0);
                 }
                 if (r.isValid())
-                    painter->drawTiledPixmap(r, pix.copy(7, 0, 8, r.height()));
+                    painter->drawTiledPixmap(r, mid);
             }
         }
         break;
@@ -3758,13 +3998,21 @@ void Style::drawControl(ControlElement element, const QStyleOption *option, QPai
         {
             if(widget && widget && QLatin1String("QtCurveConfigDialog-GradientPreview")==widget->objectName())
             {
-                Options      old=opts;
-                const QColor *use(buttonColors(option));
+                // Only the preview options are copied, the live ones are moved
+                // out of the way and back. The cached gradient stops and shade
+                // sets belong to whichever options are current, so drop them on
+                // both switches - a preview usually differs only in the custom
+                // gradient, which would otherwise be found under the same key.
+                Options old(std::move(opts));
                 opts=preview->opts;
+                clearOptionTables();
+
+                const QColor *use(buttonColors(option));
 
                 drawLightBevelReal(painter, r, option, widget, ROUNDED_ALL, getFill(option, use, false, false), use,
                                    true, WIDGET_STD_BUTTON, false, opts.round, false);
-                opts=old;
+                opts=std::move(old);
+                clearOptionTables();
             }
         }
         break;
@@ -3901,7 +4149,7 @@ void Style::drawControl(ControlElement element, const QStyleOption *option, QPai
         case LINE_NONE:
             break;
         case LINE_1DOT:
-            painter->drawPixmap(r.x()+((r.width()-5)/2), r.y()+((r.height()-5)/2), *getPixmap(border[STD_BORDER], PIX_DOT, 1.0));
+            painter->drawPixmap(r.x()+((r.width()-5)/2), r.y()+((r.height()-5)/2), getPixmap(border[STD_BORDER], PIX_DOT, 1.0));
             break;
         default:
         case LINE_DOTS:
@@ -4350,23 +4598,18 @@ void Style::drawControl(ControlElement element, const QStyleOption *option, QPai
 
             painter->save();
 
+            const QProgressBar *barWidget(qobject_cast<const QProgressBar *>(widget));
+            bool               tracked(barWidget && itsProgressBars.contains(const_cast<QProgressBar *>(barWidget)));
+
             if(indeterminate) //Busy indicator
             {
-                int chunkSize(PROGRESS_CHUNK_WIDTH*3.4),
-                    measure(vertical ? r.height() : r.width());
-
-                if(chunkSize>(measure/2))
-                    chunkSize=measure/2;
-
-                int          step(itsAnimateStep % ((measure-chunkSize) * 2));
-                QStyleOption opt(*option);
-
-                if (step > (measure-chunkSize))
-                    step = 2 * (measure-chunkSize) - step;
-
-                opt.state|=State_Raised|State_Horizontal;
-                drawProgress(painter, vertical ? QRect(r.x(), r.y()+step, r.width(), chunkSize) : QRect(r.x()+step, r.y(), chunkSize, r.height()),
-                             option, vertical);
+                drawProgress(painter, busyChunkRect(r, vertical, itsAnimateStep), option, vertical);
+                if(tracked)
+                {
+                    ProgressBarArea area={r, true, vertical};
+                    itsProgressBarAreas[widget]=area;
+                    startProgressBarTimer();
+                }
             }
             else if(r.isValid() && bar->progress>0)
             {
@@ -4374,23 +4617,30 @@ void Style::drawControl(ControlElement element, const QStyleOption *option, QPai
                 double pg = ((progress - qint64(bar->minimum)) /
                              qMax(double(1.0), double(qint64(bar->maximum) - qint64(bar->minimum))));
 
+                QRect  fill;
+
                 if(vertical)
                 {
                     int height(qMin(r.height(), (int)(pg * r.height())));
 
-                    if(inverted)
-                        drawProgress(painter, QRect(r.x(), r.y(), r.width(), height), option, true);
-                    else
-                        drawProgress(painter, QRect(r.x(), r.y()+(r.height()-height), r.width(), height), option, true);
+                    fill=inverted ? QRect(r.x(), r.y(), r.width(), height)
+                                  : QRect(r.x(), r.y()+(r.height()-height), r.width(), height);
+                    drawProgress(painter, fill, option, true);
                 }
                 else
                 {
                     int width(qMin(r.width(), (int)(pg * r.width())));
 
-                    if(reverse || inverted)
-                        drawProgress(painter, QRect(r.x()+(r.width()-width), r.y(), width, r.height()), option, false, true);
-                    else
-                        drawProgress(painter, QRect(r.x(), r.y(), width, r.height()), option);
+                    fill=reverse || inverted ? QRect(r.x()+(r.width()-width), r.y(), width, r.height())
+                                             : QRect(r.x(), r.y(), width, r.height());
+                    drawProgress(painter, fill, option, false, reverse || inverted);
+                }
+
+                if(tracked && opts.animatedProgress && bar->progress<bar->maximum)
+                {
+                    ProgressBarArea area={fill, false, vertical};
+                    itsProgressBarAreas[widget]=area;
+                    startProgressBarTimer();
                 }
             }
 
@@ -28,6 +28,7 @@
 #include <QWidget>
 #include <QSplitter>
 #include <QStatusBar>
+#include <limits.h>
 
 class QToolBar;
 
@@ -38,7 +39,13 @@ static const int constMenuPixmapWidth = 22;
 static const int constWindowMargin   =  2;
 static const int constProgressBarFps = 20;
 static const int constTabPad         =  6;
+static const int constMaxGradientStops = 256;
+static const int constMaxShadeSets = 128;
+static const int constMaxPaths = 512;
+// Entries of Style::itsPixelMetrics/itsStyleHints that need the full code.
+static const int constNotInTable = INT_MIN;
 
+static const QLatin1String constDBusStylePath("/QtCurveStyle");
 static const QLatin1String constDwtClose("qt_dockwidget_closebutton");
 static const QLatin1String constDwtFloat("qt_dockwidget_floatbutton");
 
@@ -59,6 +66,31 @@ static const QLatin1String constDwtFloat("qt_dockwidget_floatbutton");
 
 #define MO_ARROW(COL) MO_ARROW_X(state & State_MouseOver, COL)
 
+// What Style::eventFilter() may need to do for an object. Worked out once
+// per object, so that the filter does not need to cast on every event.
+enum EEventRole {
+    ROLE_MENUBAR = 1 << 0,
+    ROLE_MENU = 1 << 1,
+    ROLE_MAIN_WINDOW = 1 << 2,
+    ROLE_STATUSBAR = 1 << 3,
+    ROLE_PROGRESSBAR = 1 << 4,
+    ROLE_COMBO_POPUP = 1 << 5,
+    ROLE_LABEL = 1 << 6,
+    ROLE_FRAME = 1 << 7,
+    // Forwards clicks near the edge to the scrollbars (!gtkScrollViews)
+    ROLE_SCROLL_AREA = 1 << 8,
+    ROLE_PLACES_VIEW = 1 << 9
+};
+
+// Which item views may get square selections (SQUARE_LISTVIEW_SELECTION),
+// see Style::selectionView().
+enum ESelectionView {
+    SEL_VIEW_OTHER,
+    SEL_VIEW_TREE,
+    // Only when not in icon mode
+    SEL_VIEW_LIST
+};
+
 #define WINDOWTITLE_SPACER 0x10000000
 #define STATE_REVERSE QStyle::StateFlag(0x10000000)
 #define STATE_MENU QStyle::StateFlag(0x20000000)
@@ -29,6 +29,7 @@
 #include "utils.h"
 #include "debug.h"
 
+#include <QCoreApplication>
 #include <QDockWidget>
 #include <QMenu>
 #include <QPainter>
@@ -37,6 +38,7 @@
 
 #include "xcb_utils.h"
 #include <xcb/xcb_image.h>
+#include <xcb/xfixes.h>
 
 namespace QtCurve
 {
@@ -51,6 +53,10 @@ const char *const ShadowHelper::netWMSkipShadowPropertyName =
 //_____________________________________________________
 ShadowHelper::ShadowHelper(QObject *parent):
     QObject(parent),
+    _ownPixmaps(false),
+    _ownerWindow(0),
+    _pixmapsOwner(0),
+    _selectionNotify(-1),
     _atom(0)
 {
     createPixmapHandles();
@@ -59,6 +65,28 @@ ShadowHelper::ShadowHelper(QObject *parent):
 //_______________________________________________________
 ShadowHelper::~ShadowHelper( void )
 {
+    if (!_ownPixmaps)
+        return;
+
+    if (_ownerWindow) {
+        // destroying the window releases the selection, which tells the
+        // other processes that the pixmaps are about to go away.
+        xcb_atom_t sharedAtom =
+            XcbUtils::atom(XcbUtils::ATOM_QTC_SHADOW_PIXMAPS);
+        auto reply = XcbCall(get_property, 0, XcbUtils::rootWindow(),
+                             sharedAtom, XCB_ATOM_CARDINAL, 1, 1);
+        if (reply) {
+            if (reply->format == 32 &&
+                xcb_get_property_value_length(reply) ==
+                int(sizeof(uint32_t)) &&
+                *(uint32_t*)xcb_get_property_value(reply) == _ownerWindow) {
+                XcbCallVoid(delete_property, XcbUtils::rootWindow(),
+                            sharedAtom);
+            }
+            free(reply);
+        }
+        XcbCallVoid(destroy_window, _ownerWindow);
+    }
     for (int i = 0;i < numPixmaps;++i) {
         XcbCallVoid(free_pixmap, _pixmaps[i]);
     }
@@ -172,12 +200,211 @@ void ShadowHelper::createPixmapHandles()
 
     // create atom
     if (!_atom)
-        _atom = XcbUtils::getAtom(netWMShadowAtomName);
+        _atom = XcbUtils::atom(XcbUtils::ATOM_KDE_NET_WM_SHADOW);
+    _size = shadow_img_width[numPixmaps - 1];
+
+    /*
+      the shadow images are the same for every QtCurve application, so only
+      the first one in a session uploads them and the others reuse its
+      pixmaps for as long as that process is running. The process holds a
+      selection while it publishes them, and the others are told through
+      XFixes when it goes away (see replaceSharedPixmaps()). Without XFixes
+      that cannot be noticed, so every process uses its own pixmaps.
+    */
+    if (!(watchPixmapsOwner() && findSharedPixmaps()))
+        uploadPixmaps();
+}
+
+//______________________________________________
+static uint32_t shadowDataHash()
+{
+    // FNV-1a over the images, so that pixmaps uploaded by an application
+    // using another QtCurve version (with other shadows) are not used.
+    static uint32_t hash = 0;
+    if (!hash) {
+        hash = 2166136261u;
+        for (size_t i = 0;i < sizeof(shadow_img_len) / sizeof(size_t);i++) {
+            for (size_t j = 0;j < shadow_img_len[i];j++) {
+                hash = (hash ^ shadow_img_data[i][j]) * 16777619u;
+            }
+        }
+    }
+    return hash;
+}
+
+//______________________________________________
+bool ShadowHelper::watchPixmapsOwner()
+{
+    xcb_connection_t *conn = XcbUtils::getConnection();
+    const xcb_query_extension_reply_t *ext =
+        xcb_get_extension_data(conn, &xcb_xfixes_id);
+    if (!(ext && ext->present))
+        return false;
+    auto version = XcbCall(xfixes_query_version, XCB_XFIXES_MAJOR_VERSION,
+                           XCB_XFIXES_MINOR_VERSION);
+    if (!version)
+        return false;
+    free(version);
+
+    XcbCallVoid(xfixes_select_selection_input, XcbUtils::rootWindow(),
+                XcbUtils::atom(XcbUtils::ATOM_QTC_SHADOW_OWNER),
+                XCB_XFIXES_SELECTION_EVENT_MASK_SET_SELECTION_OWNER |
+                XCB_XFIXES_SELECTION_EVENT_MASK_SELECTION_WINDOW_DESTROY |
+                XCB_XFIXES_SELECTION_EVENT_MASK_SELECTION_CLIENT_CLOSE);
+    _selectionNotify = ext->first_event + XCB_XFIXES_SELECTION_NOTIFY;
+    QCoreApplication::instance()->installNativeEventFilter(this);
+    return true;
+}
+
+//______________________________________________
+bool ShadowHelper::findSharedPixmaps()
+{
+    /*
+      the root window property holds the data hash, the owner window and the
+      pixmaps. It is only used if that window still holds the selection,
+      since two processes starting at the same time may both publish.
+    */
+    xcb_connection_t *conn = XcbUtils::getConnection();
+    xcb_get_selection_owner_cookie_t ownerCookie =
+        xcb_get_selection_owner(conn,
+                                XcbUtils::atom(XcbUtils::ATOM_QTC_SHADOW_OWNER));
+    xcb_get_property_cookie_t propCookie =
+        xcb_get_property(conn, 0, XcbUtils::rootWindow(),
+                         XcbUtils::atom(XcbUtils::ATOM_QTC_SHADOW_PIXMAPS),
+                         XCB_ATOM_CARDINAL, 0, 2 + numPixmaps);
+    xcb_get_selection_owner_reply_t *ownerReply =
+        xcb_get_selection_owner_reply(conn, ownerCookie, 0);
+    xcb_get_property_reply_t *reply =
+        xcb_get_property_reply(conn, propCookie, 0);
+
+    xcb_window_t owner = ownerReply ? ownerReply->owner : 0;
+    xcb_pixmap_t pixmaps[numPixmaps];
+    bool found = false;
+    if (owner && reply && reply->format == 32 &&
+        xcb_get_property_value_length(reply) ==
+        int(sizeof(uint32_t) * (2 + numPixmaps))) {
+        const uint32_t *data = (const uint32_t*)xcb_get_property_value(reply);
+        if (data[0] == shadowDataHash() && data[1] == owner) {
+            memcpy(pixmaps, data + 2, sizeof(pixmaps));
+            found = true;
+        }
+    }
+    free(ownerReply);
+    free(reply);
+
+    if (!found || !pixmapsValid(pixmaps, numPixmaps))
+        return false;
+
+    memcpy(_pixmaps, pixmaps, sizeof(_pixmaps));
+    _pixmapsOwner = owner;
+    _ownPixmaps = false;
+    return true;
+}
+
+//______________________________________________
+bool ShadowHelper::pixmapsValid(const xcb_pixmap_t *pixmaps, int count) const
+{
+    /*
+      pixmaps are freed with the process that created them and their IDs may
+      be reused afterwards, so check both existence and geometry. All
+      requests are sent before waiting for the first reply.
+    */
+    xcb_connection_t *conn = XcbUtils::getConnection();
+    xcb_get_geometry_cookie_t cookies[numPixmaps];
+    for (int i = 0;i < count;i++) {
+        cookies[i] = xcb_get_geometry(conn, pixmaps[i]);
+    }
+
+    bool valid = true;
+    for (int i = 0;i < count;i++) {
+        xcb_get_geometry_reply_t *reply =
+            xcb_get_geometry_reply(conn, cookies[i], 0);
+        if (!(reply && reply->depth == 32 &&
+              reply->width == shadow_img_width[i] &&
+              reply->height == shadow_img_height[i])) {
+            valid = false;
+        }
+        free(reply);
+    }
+    return valid;
+}
+
+//______________________________________________
+bool ShadowHelper::nativeEventFilter(const QByteArray &eventType,
+                                     void *message, long*)
+{
+    if (eventType != "xcb_generic_event_t")
+        return false;
+    xcb_generic_event_t *event = (xcb_generic_event_t*)message;
+    if ((event->response_type & ~0x80) != _selectionNotify)
+        return false;
+    auto notify = (xcb_xfixes_selection_notify_event_t*)event;
+    if (notify->selection !=
+        XcbUtils::atom(XcbUtils::ATOM_QTC_SHADOW_OWNER))
+        return false;
+
+    // this process' own pixmaps stay valid for as long as it runs
+    if (!_ownPixmaps && notify->owner != _pixmapsOwner)
+        replaceSharedPixmaps();
+    return false;
+}
+
+//______________________________________________
+void ShadowHelper::replaceSharedPixmaps()
+{
+    // the process that uploaded the pixmaps in use has exited (or is about
+    // to), use the ones published since by another process, or upload them.
+    if (!findSharedPixmaps())
+        uploadPixmaps();
+
+    // the windows that already have a shadow refer to the old pixmaps
+    for (auto iter = _widgets.constBegin();iter != _widgets.constEnd();++iter) {
+        if (iter.value()) {
+            setShadowProperty(iter.value());
+        }
+    }
+}
+
+//______________________________________________
+void ShadowHelper::uploadPixmaps()
+{
     for (int i = 0;i < numPixmaps;i++) {
         _pixmaps[i] = XcbUtils::generateId();
         createPixmap(_pixmaps[i], shadow_img_data[i], shadow_img_len[i],
                      shadow_img_width[i], shadow_img_height[i]);
     }
+    _ownPixmaps = true;
+    _pixmapsOwner = 0;
+
+    // nobody would notice when this process exits
+    if (_selectionNotify < 0) {
+        XcbUtils::flush();
+        return;
+    }
+
+    // publish them, together with the window holding the owner selection.
+    // Two applications starting at the same time may both get here, only
+    // the pixmaps of the one that got the selection last are used by others.
+    if (!_ownerWindow) {
+        const uint32_t overrideRedirect = 1;
+        _ownerWindow = XcbUtils::generateId();
+        XcbCallVoid(create_window, XCB_COPY_FROM_PARENT, _ownerWindow,
+                    XcbUtils::rootWindow(), -1, -1, 1, 1, 0,
+                    XCB_WINDOW_CLASS_INPUT_ONLY, XCB_COPY_FROM_PARENT,
+                    XCB_CW_OVERRIDE_REDIRECT, &overrideRedirect);
+    }
+    XcbCallVoid(set_selection_owner, _ownerWindow,
+                XcbUtils::atom(XcbUtils::ATOM_QTC_SHADOW_OWNER),
+                XCB_CURRENT_TIME);
+
+    uint32_t data[2 + numPixmaps];
+    data[0] = shadowDataHash();
+    data[1] = _ownerWindow;
+    memcpy(data + 2, _pixmaps, sizeof(_pixmaps));
+    XcbCallVoid(change_property, XCB_PROP_MODE_REPLACE,
+                XcbUtils::rootWindow(),
+                XcbUtils::atom(XcbUtils::ATOM_QTC_SHADOW_PIXMAPS),
+                XCB_ATOM_CARDINAL, 32, 2 + numPixmaps, data);
     XcbUtils::flush();
 }
 
@@ -214,6 +441,13 @@ bool ShadowHelper::installX11Shadows( QWidget* widget )
           widget->internalWinId()))
         return false;
 
+    setShadowProperty(widget->winId());
+    return true;
+}
+
+//_______________________________________________________
+void ShadowHelper::setShadowProperty(WId id) const
+{
     // create data
     // add pixmap handles
     QVector<uint32_t> data;
@@ -225,10 +459,9 @@ bool ShadowHelper::installX11Shadows( QWidget* widget )
     data << _size - 4 << _size - 4 << _size - 4 << _size - 4;
 
     XcbCallVoid(change_property, XCB_PROP_MODE_REPLACE,
-                widget->winId(), _atom, XCB_ATOM_CARDINAL,
+                id, _atom, XCB_ATOM_CARDINAL,
                 32, data.size(), data.constData());
     XcbUtils::flush();
-    return true;
 }
 
 //_______________________________________________________
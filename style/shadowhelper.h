@@ -29,6 +29,7 @@
 
 #include "config.h"
 #include <QObject>
+#include <QAbstractNativeEventFilter>
 #include <QMap>
 #include <qwindowdefs.h>
 #include <xcb/xcb.h>
@@ -38,7 +39,7 @@ class QPixmap;
 namespace QtCurve
 {
 //! handle shadow pixmaps passed to window manager via X property
-class ShadowHelper: public QObject
+class ShadowHelper: public QObject, public QAbstractNativeEventFilter
 {
     Q_OBJECT
 public:
@@ -62,6 +63,9 @@ public:
     //! event filter
     virtual bool eventFilter(QObject*, QEvent*) override;
 
+    //! native event filter, follows the owner of the shared pixmaps
+    virtual bool nativeEventFilter(const QByteArray&, void*, long*) override;
+
 protected:
     //! unregister widget
     void objectDeleted(QObject*);
@@ -75,6 +79,24 @@ protected:
     // create pixmap handles from tileset
     void createPixmapHandles();
 
+    //! use the pixmaps published on the root window by another process
+    /*! returns false if there are none or they are no longer valid */
+    bool findSharedPixmaps();
+
+    //! true if the given pixmaps exist and match the shadow images
+    bool pixmapsValid(const xcb_pixmap_t *pixmaps, int count) const;
+
+    //! watch the owner of the shared pixmaps with XFixes
+    /*! returns false if the extension is not available */
+    bool watchPixmapsOwner();
+
+    //! switch to other pixmaps after the owner of the shared ones went away
+    /*! the shadows of all registered widgets are reinstalled */
+    void replaceSharedPixmaps();
+
+    //! upload the shadow images and publish them on the root window
+    void uploadPixmaps();
+
     // create pixmap handle from pixmap
     void createPixmap(xcb_pixmap_t pixmap, const uchar *buf, size_t len,
                       size_t width, size_t height);
@@ -86,6 +108,9 @@ protected:
     */
     bool installX11Shadows(QWidget*);
 
+    //! set the shadow X11 property on given window
+    void setShadowProperty(WId) const;
+
     //! uninstall shadow X11 property on given widget
     void uninstallX11Shadows(QWidget*) const;
 
@@ -106,6 +131,18 @@ private:
     xcb_pixmap_t _pixmaps[numPixmaps];
     //@}
 
+    //! true if the pixmaps were uploaded by this process
+    bool _ownPixmaps;
+
+    //! window holding the owner selection while this process publishes its pixmaps
+    xcb_window_t _ownerWindow;
+
+    //! selection owner that published the pixmaps in use, if not this process
+    xcb_window_t _pixmapsOwner;
+
+    //! XFixes selection notify event type, -1 if not available
+    int _selectionNotify;
+
     //! shadow size
     int _size;
 
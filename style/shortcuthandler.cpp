@@ -22,6 +22,11 @@
 #include <QWidget>
 #include <QMenu>
 #include <QMenuBar>
+#include <QAbstractButton>
+#include <QLabel>
+#include <QGroupBox>
+#include <QTabBar>
+#include <QStyleOption>
 #include <QEvent>
 #include <QKeyEvent>
 
@@ -66,19 +71,99 @@ bool ShortcutHandler::showShortcut(const QWidget *widget) const
     return itsAltDown && hasSeenAlt(widget);
 }
 
+static bool hasMnemonic(const QString &text)
+{
+    // '&&' is a literal ampersand, not a mnemonic.
+    for(int pos=text.indexOf(QLatin1Char('&')); pos>=0 && pos<text.length()-1;
+        pos=text.indexOf(QLatin1Char('&'), pos+2))
+        if(QLatin1Char('&')!=text[pos+1])
+            return true;
+    return false;
+}
+
+// The part of the widget whose look depends on whether mnemonics are
+// shown, empty if its current text has none.
+static QRegion mnemonicRegion(QWidget *widget)
+{
+    QRegion region;
+
+    if(QMenuBar *menuBar=qobject_cast<QMenuBar*>(widget))
+    {
+        foreach(QAction *action, menuBar->actions())
+            if(action->isVisible() && hasMnemonic(action->text()))
+                region+=menuBar->actionGeometry(action);
+    }
+    else if(QTabBar *tabBar=qobject_cast<QTabBar*>(widget))
+    {
+        for(int i=0; i<tabBar->count(); ++i)
+            if(hasMnemonic(tabBar->tabText(i)))
+                region+=tabBar->tabRect(i);
+    }
+    else if(QAbstractButton *button=qobject_cast<QAbstractButton*>(widget))
+    {
+        if(hasMnemonic(button->text()))
+            region=button->rect();
+    }
+    else if(QLabel *label=qobject_cast<QLabel*>(widget))
+    {
+        // QLabel only draws a mnemonic if it has a buddy.
+        if(label->buddy() && hasMnemonic(label->text()))
+            region=label->contentsRect();
+    }
+    else if(QGroupBox *groupBox=qobject_cast<QGroupBox*>(widget))
+    {
+        if(hasMnemonic(groupBox->title()))
+        {
+            QStyleOptionGroupBox opt;
+
+            opt.initFrom(groupBox);
+            opt.text=groupBox->title();
+            opt.textAlignment=groupBox->alignment();
+            opt.subControls=QStyle::SC_GroupBoxFrame|QStyle::SC_GroupBoxLabel;
+            if(groupBox->isCheckable())
+                opt.subControls|=QStyle::SC_GroupBoxCheckBox;
+            if(groupBox->isFlat())
+                opt.features|=QStyleOptionFrame::Flat;
+            region=groupBox->style()->subControlRect(QStyle::CC_GroupBox, &opt,
+                                                     QStyle::SC_GroupBoxLabel, groupBox);
+        }
+    }
+    return region;
+}
+
+void ShortcutHandler::registerWidget(QWidget *widget)
+{
+    if(!itsMnemonicWidgets.contains(widget) &&
+       (qobject_cast<QAbstractButton*>(widget) || qobject_cast<QLabel*>(widget) ||
+        qobject_cast<QGroupBox*>(widget) || qobject_cast<QTabBar*>(widget) ||
+        qobject_cast<QMenuBar*>(widget)))
+    {
+        itsMnemonicWidgets.insert(widget);
+        connect(widget, &QWidget::destroyed,
+                this, &ShortcutHandler::widgetDestroyed, Qt::UniqueConnection);
+    }
+}
+
+void ShortcutHandler::unregisterWidget(QWidget *widget)
+{
+    itsMnemonicWidgets.remove(widget);
+    itsUpdated.remove(widget);
+}
+
 void ShortcutHandler::widgetDestroyed(QObject *o)
 {
     itsUpdated.remove(static_cast<QWidget *>(o));
+    itsMnemonicWidgets.remove(static_cast<QWidget *>(o));
     itsOpenMenus.removeAll(static_cast<QWidget *>(o));
 }
 
-void ShortcutHandler::updateWidget(QWidget *w)
+void ShortcutHandler::updateWidget(QWidget *w, const QRegion &region)
 {
     if (!itsUpdated.contains(w)) {
-        itsUpdated.insert(w);
-        w->update();
+        itsUpdated.insert(w, region);
+        w->update(region);
         connect(w, &QWidget::destroyed,
-                this, &ShortcutHandler::widgetDestroyed);
+                this, &ShortcutHandler::widgetDestroyed, Qt::UniqueConnection);
     }
 }
 
@@ -97,39 +182,43 @@ bool ShortcutHandler::eventFilter(QObject *o, QEvent *e)
             if(qobject_cast<QMenu *>(widget))
             {
                 itsSeenAlt.insert(widget);
-                updateWidget(widget);
+                updateWidget(widget, widget->rect());
                 if(widget->parentWidget() && widget->parentWidget()->window())
                     itsSeenAlt.insert(widget->parentWidget()->window());
             }
             else
             {
                 widget = widget->window();
-                itsSeenAlt.insert(widget);
-                QList<QWidget*> l = widget->findChildren<QWidget*>();
-                for (int pos = 0;pos < l.size();++pos) {
-                    QWidget *w = l.at(pos);
-                    if (!(w->isWindow() || !w->isVisible())) // || w->style()->styleHint(QStyle::SH_UnderlineShortcut, 0, w)))
-                        updateWidget(w);
-                }
-
-                QList<QMenuBar*> m = widget->findChildren<QMenuBar*>();
-                for (int i = 0;i < m.size();++i) {
-                    updateWidget(m.at(i));
+                // The key press is also sent to the parents of the focus
+                // widget, only need to look at the window once.
+                if (!itsSeenAlt.contains(widget)) {
+                    itsSeenAlt.insert(widget);
+                    // Only repaint the text of widgets showing a mnemonic,
+                    // not the whole window.
+                    foreach (QWidget *w, itsMnemonicWidgets) {
+                        if (w->isVisible() && w->window() == widget) {
+                            QRegion region(mnemonicRegion(w));
+                            if (!region.isEmpty())
+                                updateWidget(w, region);
+                        }
+                    }
                 }
             }
         }
         break;
     case QEvent::WindowDeactivate:
     case QEvent::KeyRelease:
-        if (QEvent::WindowDeactivate==e->type() || Qt::Key_Alt==static_cast<QKeyEvent*>(e)->key())
+        // Both are also sent to the parents (or children) of the widget,
+        // nothing to do once Alt has been released.
+        if (itsAltDown && (QEvent::WindowDeactivate==e->type() || Qt::Key_Alt==static_cast<QKeyEvent*>(e)->key()))
         {
             itsAltDown = false;
-            QSet<QWidget *>::ConstIterator it(itsUpdated.constBegin()),
+            QHash<QWidget *, QRegion>::ConstIterator it(itsUpdated.constBegin()),
                 end(itsUpdated.constEnd());
 
             for (; it!=end; ++it)
-                (*it)->update();
-            if(!itsUpdated.contains(widget))
+                it.key()->update(it.value());
+            if(!itsUpdated.contains(widget) && qobject_cast<QMenu *>(widget))
                 widget->update();
             itsSeenAlt.clear();
             itsUpdated.clear();
@@ -24,6 +24,8 @@
 #include <QObject>
 #include <QSet>
 #include <QList>
+#include <QHash>
+#include <QRegion>
 
 class QWidget;
 
@@ -40,15 +42,20 @@ public:
     bool hasSeenAlt(const QWidget *widget) const;
     bool isAltDown() const { return itsAltDown; }
     bool showShortcut(const QWidget *widget) const;
+    void registerWidget(QWidget *widget);
+    void unregisterWidget(QWidget *widget);
 
 protected:
-    void updateWidget(QWidget *w);
+    void updateWidget(QWidget *w, const QRegion &region);
     bool eventFilter(QObject *watched, QEvent *event);
 
 private:
     bool itsAltDown;
     QSet<QWidget*> itsSeenAlt,
-        itsUpdated;
+        // Widgets that can draw a mnemonic (buttons, labels, tab bars,...)
+        itsMnemonicWidgets;
+    // Widgets repainted when Alt was pressed, with the area repainted.
+    QHash<QWidget*, QRegion> itsUpdated;
     QList<QWidget*> itsOpenMenus;
 
     void widgetDestroyed(QObject *o);
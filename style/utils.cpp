@@ -23,6 +23,9 @@
 #  include "xcb_utils.h"
 #include <QApplication>
 #include <QDesktopWidget>
+#include <QAbstractNativeEventFilter>
+#include <QHash>
+#include <xcb/xfixes.h>
 #endif
 #include <stdio.h>
 
@@ -39,28 +42,179 @@ namespace QtCurve
 namespace Utils
 {
 
-bool compositingActive()
-{
-#if defined QTC_QT_ONLY
 #ifdef QTC_X11
-    static xcb_atom_t atom;
-    if (!atom) {
-        char atomName[100] = "_NET_WM_CM_S";
-        size_t len = strlen("_NET_WM_CM_S");
-        len += sprintf(atomName + len, "%d",
-                       QApplication::desktop()->primaryScreen());
-        atom = XcbUtils::getAtom(atomName);
-        if (!atom) {
-            return false;
+/*
+  Keeps track of the compositing manager selection (_NET_WM_CM_Sn) and of
+  the depth of the windows we have been asked about, so that the painting
+  code does not need a server round trip for each query.
+
+  The selection owner is followed through XFixes selection notify events,
+  if the extension is not available the owner is queried on every call as
+  before. Window depths are keyed by WId and dropped when the window id
+  changes or the widget is destroyed.
+*/
+class WindowInfoTracker : public QObject, public QAbstractNativeEventFilter {
+public:
+    WindowInfoTracker();
+
+    bool compositingActive();
+    bool hasAlphaChannel(const QWidget *window);
+
+protected:
+    bool eventFilter(QObject *o, QEvent *e) override;
+    bool nativeEventFilter(const QByteArray &eventType, void *message,
+                           long *result) override;
+
+private:
+    void forgetWindow(QObject *o);
+    bool queryCompositing() const;
+
+    bool itsHaveX11;
+    xcb_atom_t itsCmAtom;
+    int itsSelectionNotify;
+    bool itsCompositing;
+    QHash<WId, bool> itsArgbWindows;
+    QHash<QObject*, WId> itsWindowIds;
+};
+
+WindowInfoTracker::WindowInfoTracker() :
+    itsHaveX11(QX11Info::isPlatformX11()),
+    itsCmAtom(0),
+    itsSelectionNotify(-1),
+    itsCompositing(false)
+{
+    if (!itsHaveX11)
+        return;
+
+    itsCmAtom = XcbUtils::atom(XcbUtils::ATOM_NET_WM_CM_S);
+    if (!itsCmAtom)
+        return;
+
+    xcb_connection_t *conn = XcbUtils::getConnection();
+    const xcb_query_extension_reply_t *ext =
+        xcb_get_extension_data(conn, &xcb_xfixes_id);
+    if (ext && ext->present) {
+        auto version = XcbCall(xfixes_query_version, XCB_XFIXES_MAJOR_VERSION,
+                               XCB_XFIXES_MINOR_VERSION);
+        if (version) {
+            free(version);
+            XcbCallVoid(xfixes_select_selection_input,
+                        XcbUtils::rootWindow(), itsCmAtom,
+                        XCB_XFIXES_SELECTION_EVENT_MASK_SET_SELECTION_OWNER |
+                        XCB_XFIXES_SELECTION_EVENT_MASK_SELECTION_WINDOW_DESTROY |
+                        XCB_XFIXES_SELECTION_EVENT_MASK_SELECTION_CLIENT_CLOSE);
+            XcbUtils::flush();
+            itsSelectionNotify =
+                ext->first_event + XCB_XFIXES_SELECTION_NOTIFY;
+            QCoreApplication::instance()->installNativeEventFilter(this);
         }
     }
-    auto reply = XcbCall(get_selection_owner, atom);
+    itsCompositing = queryCompositing();
+}
+
+bool
+WindowInfoTracker::queryCompositing() const
+{
+    auto reply = XcbCall(get_selection_owner, itsCmAtom);
     bool res = false;
     if (reply) {
         res = reply->owner != 0;
         free(reply);
     }
     return res;
+}
+
+bool
+WindowInfoTracker::compositingActive()
+{
+    if (!itsCmAtom)
+        return false;
+    if (itsSelectionNotify < 0)
+        itsCompositing = queryCompositing();
+    return itsCompositing;
+}
+
+bool
+WindowInfoTracker::hasAlphaChannel(const QWidget *window)
+{
+    if (!itsHaveX11)
+        return false;
+    WId wid = window ? window->winId() : 0;
+    if (!wid)
+        return true;
+
+    QHash<WId, bool>::ConstIterator it = itsArgbWindows.constFind(wid);
+    if (it != itsArgbWindows.constEnd())
+        return it.value();
+
+    auto reply = XcbCall(get_geometry, wid);
+    bool res = false;
+    if (reply) {
+        res = reply->depth == 32;
+        free(reply);
+    }
+    QWidget *w = const_cast<QWidget*>(window);
+    if (!itsWindowIds.contains(w)) {
+        w->installEventFilter(this);
+        connect(w, &QWidget::destroyed,
+                this, &WindowInfoTracker::forgetWindow);
+    }
+    itsWindowIds.insert(w, wid);
+    itsArgbWindows.insert(wid, res);
+    return res;
+}
+
+void
+WindowInfoTracker::forgetWindow(QObject *o)
+{
+    QHash<QObject*, WId>::Iterator it = itsWindowIds.find(o);
+    if (it != itsWindowIds.end()) {
+        itsArgbWindows.remove(it.value());
+        itsWindowIds.erase(it);
+    }
+}
+
+bool
+WindowInfoTracker::eventFilter(QObject *o, QEvent *e)
+{
+    if (e->type() == QEvent::WinIdChange) {
+        QHash<QObject*, WId>::ConstIterator it = itsWindowIds.constFind(o);
+        if (it != itsWindowIds.constEnd()) {
+            itsArgbWindows.remove(it.value());
+        }
+    }
+    return false;
+}
+
+bool
+WindowInfoTracker::nativeEventFilter(const QByteArray &eventType,
+                                     void *message, long*)
+{
+    if (eventType != "xcb_generic_event_t")
+        return false;
+    xcb_generic_event_t *event = (xcb_generic_event_t*)message;
+    if ((event->response_type & ~0x80) == itsSelectionNotify) {
+        auto notify = (xcb_xfixes_selection_notify_event_t*)event;
+        if (notify->selection == itsCmAtom) {
+            itsCompositing = notify->owner != XCB_NONE;
+        }
+    }
+    return false;
+}
+
+static WindowInfoTracker*
+windowInfoTracker()
+{
+    static WindowInfoTracker *tracker = new WindowInfoTracker;
+    return tracker;
+}
+#endif
+
+bool compositingActive()
+{
+#if defined QTC_QT_ONLY
+#ifdef QTC_X11
+    return windowInfoTracker()->compositingActive();
 #else // QTC_X11
     return false;
 #endif // QTC_X11
@@ -73,17 +227,8 @@ bool hasAlphaChannel(const QWidget *widget)
 {
 #ifdef QTC_X11
     if (compositingActive()) {
-        WId wid = widget ? widget->window()->winId() : 0;
-        if (wid) {
-            auto reply = XcbCall(get_geometry, wid);
-            bool res = false;
-            if (reply) {
-                res = reply->depth == 32;
-                free(reply);
-            }
-            return res;
-        }
-        return true;
+        return windowInfoTracker()->hasAlphaChannel(widget ? widget->window() :
+                                                    0);
     } else {
         return false;
     }
@@ -653,7 +653,7 @@ void WindowManager::startDrag( QWidget* widget, const QPoint& position )
         XcbCallVoid(ungrab_pointer, 0L);
 #ifdef QTC_QT_ONLY
         static const auto moveResizeAtom =
-            XcbUtils::getAtom("_NET_WM_MOVERESIZE");
+            XcbUtils::atom(XcbUtils::ATOM_NET_WM_MOVERESIZE);
         union {
             char _buff[32];
             xcb_client_message_event_t ev;
@@ -20,6 +20,9 @@
 
 #include "xcb_utils.h"
 #include "qtcurve_p.h"
+#include <QCoreApplication>
+#include <QEvent>
+#include <QHash>
 
 namespace QtCurve
 {
@@ -47,6 +50,143 @@ getAtoms(size_t n, xcb_atom_t *atoms, const char *const names[], bool create)
     free(cookies);
 }
 
+static xcb_atom_t atoms[NUM_ATOMS];
+static bool atomsInterned = false;
+
+void
+internAtoms()
+{
+    if (atomsInterned)
+        return;
+    atomsInterned = true;
+    if (!QX11Info::isPlatformX11())
+        return;
+
+    char cmName[100] = "_NET_WM_CM_S";
+    sprintf(cmName + strlen(cmName), "%d",
+            QApplication::desktop()->primaryScreen());
+    // Same order as AtomId
+    const char *const names[NUM_ATOMS] = {
+        cmName,
+        "_NET_WM_MOVERESIZE",
+        "_KDE_NET_WM_SHADOW",
+        "_KDE_NET_WM_BLUR_BEHIND_REGION",
+        MENU_SIZE_ATOM,
+        STATUSBAR_ATOM,
+        OPACITY_ATOM,
+        BGND_ATOM,
+        "_QTCURVE_SHADOW_PIXMAPS_",
+        "_QTCURVE_SHADOW_OWNER_"
+    };
+    getAtoms(NUM_ATOMS, atoms, names);
+}
+
+xcb_atom_t
+atom(AtomId id)
+{
+    internAtoms();
+    return atoms[id];
+}
+
+namespace {
+
+// The values last written to each window, so that polishing the same window
+// (or its children) again does not send the same properties over and over.
+class PropertyStore : public QObject {
+public:
+    PropertyStore() :
+        itsFlushQueued(false),
+        itsSuppressed(0)
+    {
+    }
+
+    void change(QWidget *window, xcb_atom_t atom, xcb_atom_t type,
+                uint8_t format, uint32_t len, const void *data);
+    quint64 suppressed() const
+    {
+        return itsSuppressed;
+    }
+
+protected:
+    void customEvent(QEvent *event) override;
+
+private:
+    struct Window {
+        WId wid;
+        QHash<xcb_atom_t, QByteArray> values;
+    };
+
+    QHash<const QObject*, Window> itsWindows;
+    bool itsFlushQueued;
+    quint64 itsSuppressed;
+};
+
+void
+PropertyStore::change(QWidget *window, xcb_atom_t atom, xcb_atom_t type,
+                      uint8_t format, uint32_t len, const void *data)
+{
+    WId wid = window->winId();
+    QHash<const QObject*, Window>::iterator it = itsWindows.find(window);
+    if (it == itsWindows.end()) {
+        it = itsWindows.insert(window, Window());
+        connect(window, &QObject::destroyed, this, [this] (QObject *obj) {
+                itsWindows.remove(obj);
+            });
+    }
+    // The native window was recreated, its properties are gone.
+    if (it->wid != wid) {
+        it->wid = wid;
+        it->values.clear();
+    }
+
+    QByteArray value((const char*)&type, sizeof(type));
+    value += (char)format;
+    value.append((const char*)data, len * (format / 8));
+    QByteArray &last = it->values[atom];
+    if (last == value) {
+        itsSuppressed++;
+        return;
+    }
+    last = value;
+    XcbCallVoid(change_property, XCB_PROP_MODE_REPLACE, wid, atom, type,
+                format, len, data);
+    if (!itsFlushQueued) {
+        itsFlushQueued = true;
+        QCoreApplication::postEvent(this, new QEvent(QEvent::User));
+    }
+}
+
+void
+PropertyStore::customEvent(QEvent *event)
+{
+    if (event->type() == QEvent::User) {
+        itsFlushQueued = false;
+        flush();
+    }
+}
+
+static PropertyStore&
+propertyStore()
+{
+    static PropertyStore store;
+    return store;
+}
+
+}
+
+void
+changeProperty(QWidget *window, xcb_atom_t atom, xcb_atom_t type,
+               uint8_t format, uint32_t len, const void *data)
+{
+    propertyStore().change(window, atom, type, format, len, data);
+}
+
+quint64
+suppressedPropertyWrites()
+{
+    return propertyStore().suppressed();
+}
+
 static QByteArray
 getWMClass()
 {
@@ -56,13 +196,11 @@ getWMClass()
 }
 
 void
-setWindowWMClass(WId wid)
+setWindowWMClass(QWidget *window)
 {
-    static const auto wmclassAtom = XcbUtils::getAtom("WM_CLASS");
     static QByteArray wmclass = getWMClass();
-    XcbCallVoid(change_property, XCB_PROP_MODE_REPLACE,
-                wid, wmclassAtom, XCB_ATOM_STRING, 8, wmclass.count(),
-                wmclass.constData());
+    changeProperty(window, XCB_ATOM_WM_CLASS, XCB_ATOM_STRING, 8,
+                   wmclass.count(), wmclass.constData());
 }
 
 }
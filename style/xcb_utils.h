@@ -66,7 +66,36 @@ getAtom(const char *name, bool create=false)
     return atom;
 }
 
-void setWindowWMClass(WId id);
+// Atoms used by the style, interned together by internAtoms().
+enum AtomId {
+    ATOM_NET_WM_CM_S, // For the primary screen
+    ATOM_NET_WM_MOVERESIZE,
+    ATOM_KDE_NET_WM_SHADOW,
+    ATOM_KDE_NET_WM_BLUR_BEHIND_REGION,
+    ATOM_QTC_MENU_SIZE,
+    ATOM_QTC_STATUSBAR,
+    ATOM_QTC_OPACITY,
+    ATOM_QTC_BGND,
+    ATOM_QTC_SHADOW_PIXMAPS,
+    ATOM_QTC_SHADOW_OWNER,
+
+    NUM_ATOMS
+};
+
+// Intern all of the atoms above with a single round trip, does nothing
+// after the first call.
+void internAtoms();
+xcb_atom_t atom(AtomId id);
+
+void setWindowWMClass(QWidget *window);
+
+// Set a property of the native window of window, unless that value was the
+// last one written to it. The requests are flushed together once control
+// returns to the event loop.
+void changeProperty(QWidget *window, xcb_atom_t atom, xcb_atom_t type,
+                    uint8_t format, uint32_t len, const void *data);
+// Number of changeProperty() calls dropped as they would not change anything.
+quint64 suppressedPropertyWrites();
 
 template<typename RetType, typename CookieType, typename... ArgTypes,
          typename... ArgTypes2>